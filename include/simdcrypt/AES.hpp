@@ -162,8 +162,14 @@ namespace simdcrypt {
 
       void ecbEncBlock(const block &plaintext, block &ciphertext) const;
       block ecbEncBlock(const block &plaintext) const;
+      void ecbEncBlocks(const block *plaintexts, uint64_t blockLength, block *ciphertexts) const;
       void ecbEncCounterMode(uint64_t baseIdx, uint64_t blockLength, block *ciphertext) const;
 
+      // Encrypts plaintexts[i] under keys[i] for i < length. The key schedules
+      // are expanded on the fly and up to 8 of them are interleaved, which is
+      // much faster than constructing an AES for every key.
+      static void ecbEncMultiKey(const block *keys, const block *plaintexts, block *ciphertexts, uint64_t length);
+
     private:
       block round_keys[11];
   };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "AES.hpp"
+#include <algorithm>
+#include <numeric>
 #include <vector>
 
 namespace simdcrypt
@@ -39,5 +41,61 @@ namespace simdcrypt
 
             mBuffer.clear();
         }
+
+        // Hashes the n messages msgs[i] of lens[i] bytes, writing HashSize
+        // bytes per message to digests. Equivalent to one AESHash per
+        // message, but messages with the same number of blocks are advanced
+        // in lock step, so that their key schedules and encryptions
+        // interleave in AES::ecbEncMultiKey.
+        static void hashMany(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests)
+        {
+            constexpr size_t Lanes = 8;
+            auto numBlocks = [&](size_t i) { return (lens[i] + 15) / 16; };
+
+            std::vector<size_t> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                [&](size_t a, size_t b) { return numBlocks(a) < numBlocks(b); });
+
+            for (size_t g = 0; g < n; g += Lanes)
+            {
+                size_t lanes = std::min(Lanes, n - g);
+                const size_t* idx = order.data() + g;
+
+                block h[Lanes], keys[Lanes], e[Lanes];
+                for (size_t i = 0; i < lanes; ++i)
+                    h[i] = toBlock(-1ull, -1ull);
+
+                // lanes are sorted by length, so the ones still running
+                // are always [first, lanes).
+                size_t first = 0;
+                for (size_t j = 0; first < lanes; ++j)
+                {
+                    while (first < lanes && numBlocks(idx[first]) <= j)
+                        ++first;
+
+                    for (size_t i = first; i < lanes; ++i)
+                    {
+                        const uint8_t* msg = msgs[idx[i]];
+                        size_t len = lens[idx[i]];
+                        if (16 * (j + 1) <= len)
+                            keys[i] = toBlock(msg + 16 * j);
+                        else
+                        {
+                            uint8_t last[16] = {};
+                            memcpy(last, msg + 16 * j, len - 16 * j);
+                            keys[i] = toBlock(last);
+                        }
+                    }
+
+                    AES::ecbEncMultiKey(keys + first, h + first, e + first, lanes - first);
+                    for (size_t i = first; i < lanes; ++i)
+                        h[i] = xor_blocks(h[i], e[i]);
+                }
+
+                for (size_t i = 0; i < lanes; ++i)
+                    store_block(h[i], digests + HashSize * idx[i]);
+            }
+        }
     };
 } // namespace simdcrypt
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "AES.hpp"
+#include <new>
+#include <vector>
+
+namespace simdcrypt
+{
+    // How the memory of a BlockArena is backed by huge pages.
+    enum class HugePages
+    {
+        // regular pages only.
+        None,
+        // advise the kernel to use transparent huge pages (Linux).
+        Transparent,
+        // request explicit huge pages with MAP_HUGETLB (Linux). Falls back
+        // to Transparent if none are reserved.
+        Explicit
+    };
+
+    // Arena that hands out 64 byte aligned memory from a small number of
+    // large chunks. Individual deallocations are free, all memory is
+    // reclaimed at once with reset(). Chunks are mapped directly from the
+    // OS where possible, optionally huge page backed and bound to the NUMA
+    // node of the allocating thread.
+    //
+    // Not thread safe, use one arena per thread.
+    class BlockArena
+    {
+    public:
+        static constexpr size_t Alignment = 64;
+        static constexpr size_t DefaultChunkSize = size_t(64) << 20;
+
+        BlockArena(size_t chunkSize = DefaultChunkSize,
+            HugePages hugePages = HugePages::Transparent, bool numaLocal = true);
+
+        // the arena is referenced by the allocators using it, so it can
+        // be neither copied nor moved.
+        BlockArena(const BlockArena&) = delete;
+        BlockArena& operator=(const BlockArena&) = delete;
+
+        ~BlockArena();
+
+        // Returns size bytes aligned to Alignment. Requests larger than
+        // the chunk size get a chunk of their own.
+        void* allocate(size_t size);
+
+        // Only reclaims memory if ptr is the most recent allocation, e.g. a
+        // temporary released right after use. Otherwise the memory is
+        // reclaimed by reset(). A growing std::vector allocates its new
+        // buffer before freeing the old one, so each growth leaves a hole:
+        // reserve() the final size up front instead.
+        void deallocate(void* ptr, size_t size);
+
+        // Invalidates all allocations. The chunks are kept and reused.
+        void reset();
+
+        // Invalidates all allocations and returns the chunks to the OS.
+        void release();
+
+        // total bytes obtained from the OS.
+        size_t capacity() const;
+
+        // bytes handed out since the last reset.
+        size_t used() const { return mUsed; }
+
+    private:
+        struct Chunk
+        {
+            uint8_t* mData;
+            size_t mSize;
+        };
+
+        Chunk mapChunk(size_t size) const;
+        void unmapChunk(const Chunk& chunk) const;
+
+        size_t mChunkSize;
+        HugePages mHugePages;
+        bool mNumaLocal;
+
+        std::vector<Chunk> mChunks;
+        // chunk currently being allocated from, and the offset into it.
+        size_t mCurrent = 0;
+        size_t mOffset = 0;
+        uint8_t* mLast = nullptr;
+        size_t mUsed = 0;
+    };
+
+    // Standard allocator for blocks and other POD types that returns 64
+    // byte aligned memory, from the given arena or from the heap when no
+    // arena is given.
+    template <typename T>
+    class BlockAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        BlockAllocator(BlockArena* arena = nullptr) noexcept : mArena(arena) {}
+
+        template <typename U>
+        BlockAllocator(const BlockAllocator<U>& other) noexcept : mArena(other.arena()) {}
+
+        T* allocate(size_t n)
+        {
+            if (mArena)
+                return static_cast<T*>(mArena->allocate(n * sizeof(T)));
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(BlockArena::Alignment)));
+        }
+
+        void deallocate(T* ptr, size_t n)
+        {
+            if (mArena)
+                mArena->deallocate(ptr, n * sizeof(T));
+            else
+                ::operator delete(ptr, std::align_val_t(BlockArena::Alignment));
+        }
+
+        BlockArena* arena() const { return mArena; }
+
+        template <typename U>
+        bool operator==(const BlockAllocator<U>& other) const { return mArena == other.arena(); }
+
+    private:
+        BlockArena* mArena;
+    };
+
+    // as for BlockSpan, the dropped alignment attribute of __m128i is
+    // harmless.
+#if defined(__GNUC__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+    typedef std::vector<block, BlockAllocator<block>> BlockVector;
+#if defined(__GNUC__)
+  #pragma GCC diagnostic pop
+#endif
+
+} // namespace simdcrypt
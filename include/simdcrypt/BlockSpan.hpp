@@ -0,0 +1,61 @@
+#pragma once
+
+#include "AES.hpp"
+#include <span>
+
+namespace simdcrypt
+{
+    // GCC warns that the alignment attribute of __m128i is dropped from
+    // the template argument, which is harmless here.
+#if defined(__GNUC__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+    typedef std::span<block> BlockSpan;
+    typedef std::span<const block> ConstBlockSpan;
+#if defined(__GNUC__)
+  #pragma GCC diagnostic pop
+#endif
+
+    // Instruction set used by the bulk operations below. Baseline is SSE2
+    // on x86 and NEON on ARM. The best level supported by the CPU is
+    // selected at first use.
+    enum class SimdLevel
+    {
+        Baseline,
+        AVX2,
+        AVX512
+    };
+
+    // Returns the level currently used by the bulk operations.
+    SimdLevel getSimdLevel();
+
+    // Forces the bulk operations to use the given level, or the best
+    // supported one below it. Returns the level actually selected.
+    SimdLevel setSimdLevel(SimdLevel level);
+
+    // Bulk operations over arrays of blocks. All spans must have the same
+    // size, otherwise std::runtime_error is thrown. dest may alias any of
+    // the inputs exactly. Very large outputs are written with non-temporal
+    // stores so that they do not evict the working set from the cache.
+
+    // dest[i] = a[i] ^ b[i]
+    void xorBlocks(ConstBlockSpan a, ConstBlockSpan b, BlockSpan dest);
+
+    // dest[i] = a[i] & b[i]
+    void andBlocks(ConstBlockSpan a, ConstBlockSpan b, BlockSpan dest);
+
+    // bitwise select, dest[i] = (a[i] & ~mask[i]) | (b[i] & mask[i])
+    void selectBlocks(ConstBlockSpan mask, ConstBlockSpan a, ConstBlockSpan b, BlockSpan dest);
+
+    // dest[i] = bit i of bits ? a[i] : 0, where bit i is (bits[i / 8] >> (i % 8)) & 1.
+    // bits must hold at least (a.size() + 7) / 8 bytes.
+    void andBits(const uint8_t* bits, ConstBlockSpan a, BlockSpan dest);
+
+    // returns true if a[i] == b[i] for all i.
+    bool equalBlocks(ConstBlockSpan a, ConstBlockSpan b);
+
+    // returns the number of set bits in a.
+    uint64_t hammingWeight(ConstBlockSpan a);
+
+} // namespace simdcrypt
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "AES.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+
+namespace simdcrypt
+{
+    // A thread safe CTR_DRBG (NIST SP 800-90A) using AES-128 without a
+    // derivation function, meant to be shared by all threads of a process.
+    //
+    // Generate requests are RequestBlocks blocks each. Instead of updating
+    // the working state after every request, requests are grouped into
+    // epochs of epochRequests requests that share (Key, V): request r of an
+    // epoch outputs AES_Key(V + r * RequestBlocks + 1), ... so that an epoch
+    // is a single CTR_DRBG generate of epochRequests * RequestBytes. As
+    // SP 800-90A limits a generate to MaxGenerateBytes, an epoch is at most
+    // MaxEpochRequests requests. Threads reserve a request with a single
+    // atomic increment and buffer its output thread locally. The CTR_DRBG
+    // update (or reseed) that derives the next epoch does not depend on
+    // how much of the current one was used, so it is done as soon as an
+    // epoch starts, by the thread that started it. Moving to the next
+    // epoch is then a compare and swap: reservations never wait for a
+    // lock, which only serializes deriving epochs and reseeds.
+    //
+    // Only the states of the current and the next epoch are kept in
+    // memory, the previous one is overwritten right after the switch.
+    // Backtracking resistance therefore holds at the granularity of an
+    // epoch: a compromise exposes the requests of the current epoch,
+    // including those already handed out, but none before.
+    // With epochRequests = 1 the output is exactly that of CTR_DRBG with
+    // requests of RequestBytes.
+    //
+    // With prediction resistance none of the above applies: every get(...)
+    // is a CTR_DRBG generate preceded by a reseed, made under the lock.
+    //
+    // In the child of a fork() the first get(...) reseeds, and the buffers
+    // inherited from the parent are discarded, so that parent and child do
+    // not share output. This needs an entropy source: without one, get(...)
+    // throws in the child.
+    class CtrDrbg
+    {
+    public:
+        static constexpr size_t SeedLength = 32;
+        static constexpr size_t RequestBlocks = 256;
+        static constexpr size_t RequestBytes = RequestBlocks * sizeof(block);
+
+        // maximum reseed interval allowed by SP 800-90A, in requests.
+        static constexpr uint64_t MaxReseedInterval = uint64_t(1) << 48;
+
+        // maximum size of a generate request, 2^19 bits for AES-128.
+        static constexpr size_t MaxGenerateBytes = size_t(1) << 16;
+        static constexpr uint64_t MaxEpochRequests = MaxGenerateBytes / RequestBytes;
+        static constexpr uint64_t DefaultEpochRequests = MaxEpochRequests;
+
+        // Fills length bytes of full entropy, returns false on failure.
+        typedef std::function<bool(uint8_t* dest, size_t length)> EntropySource;
+
+        // Instantiates from SeedLength bytes of entropy and an optional
+        // personalization string of at most SeedLength bytes.
+        // entropySource is used to reseed once reseedInterval requests have
+        // been made, and at every get(...) if predictionResistance is set.
+        // Without a source, get(...) throws once a reseed is required and
+        // predictionResistance is not allowed. epochRequests is clamped to
+        // [1, MaxEpochRequests].
+        CtrDrbg(const uint8_t* entropy,
+            const uint8_t* personalization = nullptr, size_t personalizationLength = 0,
+            EntropySource entropySource = nullptr, bool predictionResistance = false,
+            uint64_t reseedInterval = MaxReseedInterval, uint64_t epochRequests = DefaultEpochRequests);
+
+        CtrDrbg(const CtrDrbg&) = delete;
+        CtrDrbg& operator=(const CtrDrbg&) = delete;
+
+        // Process wide instance, seeded and reseeded from std::random_device.
+        static CtrDrbg& global();
+
+        // Fills dest with length random bytes. Thread safe. With prediction
+        // resistance, calls of more than MaxGenerateBytes are split into
+        // several generates, each with its own reseed.
+        void get(uint8_t* dest, size_t length);
+
+        // Returns a random element of the given type T. Thread safe.
+        // Required: T must be a standard layout type.
+        template<typename T>
+        typename std::enable_if<std::is_standard_layout<T>::value, T>::type
+            get()
+        {
+            T ret;
+            get((uint8_t*)&ret, sizeof(T));
+            return ret;
+        }
+
+        // Reseeds from the entropy source with optional additional input of
+        // at most SeedLength bytes. The calling thread's buffered output is
+        // discarded, but other threads still serve the rest of their
+        // current request, up to RequestBytes each, and requests they
+        // already reserved from the previous state.
+        void reseed(const uint8_t* additionalInput = nullptr, size_t additionalInputLength = 0);
+
+    private:
+        // The mState word holds the epoch in its high bits and the next
+        // request of that epoch in the low RequestBits.
+        static constexpr int RequestBits = 40;
+        static constexpr uint64_t RequestMask = (uint64_t(1) << RequestBits) - 1;
+        static constexpr uint64_t EpochMask = (uint64_t(1) << (64 - RequestBits)) - 1;
+
+        // Working state of an epoch. Written under mMutex and read without
+        // a lock, like a seqlock with mEpoch as the sequence. One slot holds
+        // the current epoch and the other the next one, once prepared.
+        struct Slot
+        {
+            std::atomic<uint64_t> mEpoch{ ~uint64_t(0) };
+            std::atomic<uint64_t> mKey[2];
+            std::atomic<uint64_t> mV[2];
+        };
+        static constexpr size_t NumSlots = 2;
+
+        struct State
+        {
+            block mKey;
+            uint64_t mV[2]; // big endian 128 bit counter, high word first.
+        };
+
+        static void update(State& state, const uint8_t* providedData);
+        void reseedLocked(const uint8_t* additionalInput, size_t additionalInputLength);
+        void reseedAfterFork(uint64_t generation);
+        void reseedState(State& state, const uint8_t* additionalInput, size_t additionalInputLength);
+        bool readSlot(uint64_t epoch, State& state) const;
+        void publish(uint64_t epoch, const State& state);
+        void prepareLocked(bool forceReseed, const uint8_t* additionalInput, size_t additionalInputLength);
+        void prepare(uint64_t epoch, bool eager);
+        void switchEpoch(uint64_t epoch);
+        void generate(const State& state, uint64_t request, uint8_t* dest) const;
+        void refill(uint8_t* dest);
+        void generatePredictionResistant(uint8_t* dest, size_t length);
+
+        // identifies this instance in the thread local buffers.
+        uint64_t mId;
+
+        EntropySource mEntropySource;
+        bool mPredictionResistance;
+        uint64_t mReseedInterval;
+        uint64_t mEpochRequests;
+
+        // fork generation this instance was last reseeded in, see get(...).
+        std::atomic<uint64_t> mForkGeneration{ 0 };
+
+        // every refill increments mState, keep it away from the slots that
+        // are only read.
+        alignas(64) std::atomic<uint64_t> mState{ 0 };
+        alignas(64) Slot mSlots[NumSlots];
+
+        // guards preparing epochs, reseeds and the fields below.
+        std::mutex mMutex;
+        // state of the most recently prepared epoch, the current one or
+        // the next, or the working state with prediction resistance.
+        State mLatest;
+        uint64_t mLatestEpoch = 0;
+        uint64_t mRequestsSinceReseed = 0;
+    };
+
+} // namespace simdcrypt
@@ -1,6 +1,7 @@
 #pragma once
 // This file and the associated implementation has been placed in the public domain, waiving all copyright. No restrictions are placed on its use.
 #include "AES.hpp"
+#include "BlockAllocator.hpp"
 #include <span>
 #include <vector>
 
@@ -17,8 +18,10 @@ namespace simdcrypt
         PRNG() = default;
 
 		// explicit constructor to initialize the PRNG with the 
-		// given seed and to buffer bufferSize number of AES block
-        PRNG(const block& seed, uint64_t bufferSize = 256);
+		// given seed and to buffer bufferSize number of AES block.
+		// The buffer is obtained from allocator, which may refer
+		// to a BlockArena.
+        PRNG(const block& seed, uint64_t bufferSize = 256, BlockVector::allocator_type allocator = {});
 
 		// standard move constructor. The moved from PRNG is invalid
 		// unless SetSeed(...) is called.
@@ -136,7 +139,7 @@ namespace simdcrypt
         }
 
 		// internal buffer to store future random values.
-		std::vector<block> mBuffer;
+		BlockVector mBuffer;
 
 		// AES that generates the randomness by computing AES_seed({0,1,2,...})
 		AES mAes;
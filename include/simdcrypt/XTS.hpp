@@ -0,0 +1,68 @@
+#pragma once
+
+#include "AES.hpp"
+#include <cstddef>
+
+namespace simdcrypt
+{
+    // AES-XTS (IEEE 1619 / NIST SP 800-38E) tweakable encryption of fixed
+    // size data units ("sectors"). Supports AES-128-XTS (32 byte key) and
+    // AES-256-XTS (64 byte key). The key is Key1 || Key2, where Key1 encrypts
+    // the data and Key2 encrypts the sector number to form the initial tweak.
+    //
+    // Sector sizes that are not a multiple of 16 bytes are handled with
+    // ciphertext stealing. Sectors must be at least 16 bytes long.
+    class AESXTS
+    {
+    public:
+        static constexpr size_t BlockSize = 16;
+
+        // key must point to keyLength bytes, keyLength is 32 or 64.
+        AESXTS(const uint8_t* key, size_t keyLength);
+
+        // Encrypts/decrypts a single sector in place.
+        void encryptSector(uint8_t* data, size_t sectorSize, uint64_t sectorIndex) const;
+        void decryptSector(uint8_t* data, size_t sectorSize, uint64_t sectorIndex) const;
+
+        // Encrypts/decrypts `count` consecutive sectors of `sectorSize` bytes,
+        // the first of which has sector number firstSectorIndex. Sectors are
+        // spread across numThreads threads, where 0 picks the hardware
+        // concurrency. src and dest may alias exactly (in place) but must not
+        // otherwise overlap.
+        void encryptSectors(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+            uint64_t firstSectorIndex, uint64_t count, size_t numThreads = 0) const;
+        void decryptSectors(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+            uint64_t firstSectorIndex, uint64_t count, size_t numThreads = 0) const;
+
+        // in place variants of the above.
+        void encryptSectors(uint8_t* data, size_t sectorSize,
+            uint64_t firstSectorIndex, uint64_t count, size_t numThreads = 0) const
+        {
+            encryptSectors(data, data, sectorSize, firstSectorIndex, count, numThreads);
+        }
+        void decryptSectors(uint8_t* data, size_t sectorSize,
+            uint64_t firstSectorIndex, uint64_t count, size_t numThreads = 0) const
+        {
+            decryptSectors(data, data, sectorSize, firstSectorIndex, count, numThreads);
+        }
+
+        // Multiplies the tweak by the primitive element alpha of GF(2^128),
+        // using the little endian convention of IEEE 1619.
+        static block mulAlpha(const block& tweak);
+
+    private:
+        void processSector(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+            const block& tweak, bool encrypt) const;
+        void processSectors(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+            uint64_t firstSectorIndex, uint64_t count, size_t numThreads, bool encrypt) const;
+
+        // number of AES rounds, 10 for AES-128 and 14 for AES-256.
+        int mRounds;
+
+        // round keys of Key1 for encryption and decryption, and of Key2
+        // which is only ever used to encrypt the sector number.
+        block mEncKeys[15];
+        block mDecKeys[15];
+        block mTweakKeys[15];
+    };
+} // namespace simdcrypt
@@ -34,6 +34,115 @@ block aes_128_key_expansion(block key){
 
 #endif
 
+#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
+
+// Same as aes_128_key_expansion, but computes SubWord with aesenclast
+// instead of aeskeygenassist, which has a much lower throughput on most
+// Intel cores. With the last word broadcast to all columns ShiftRows is a
+// no-op, and RotWord commutes with SubWord.
+template <int rcon>
+inline block aes_128_key_expansion_pipelined(block key) {
+    block word = _mm_shuffle_epi32(key, _MM_SHUFFLE(3,3,3,3));
+    word = _mm_aesenclast_si128(word, _mm_setzero_si128());
+    word = _mm_or_si128(_mm_srli_epi32(word, 8), _mm_slli_epi32(word, 24));
+    word = _mm_xor_si128(word, _mm_set1_epi32(rcon));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, word);
+}
+
+#endif
+
+// Number of keys processed together by AES::ecbEncMultiKey.
+constexpr uint64_t MultiKeyLanes = 8;
+
+// One round of AES under each of the keys, expanding each key to the key
+// of this round as we go.
+template <int rcon, bool last>
+inline void multi_key_round(block *keys, block *state) {
+#if defined(__GNUC__)
+    #pragma GCC unroll 8
+#endif
+    for (uint64_t i = 0; i < MultiKeyLanes; ++i) {
+#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
+        keys[i] = aes_128_key_expansion_pipelined<rcon>(keys[i]);
+        state[i] = last ? _mm_aesenclast_si128(state[i], keys[i]) : _mm_aesenc_si128(state[i], keys[i]);
+#elif defined(HARDWARE_ACCELERATION_ARM_NEON_AES)
+        // vaeseq adds the round key first, so it takes the key of the
+        // previous round.
+        state[i] = vaeseq_u8(state[i], keys[i]);
+        keys[i] = aes_128_key_expansion<rcon>(keys[i]);
+        state[i] = last ? veorq_u8(state[i], keys[i]) : vaesmcq_u8(state[i]);
+#endif
+    }
+}
+
+// Encrypts MultiKeyLanes plaintexts, each under its own key.
+inline void multi_key_encrypt(const block *keys, const block *plaintexts, block *ciphertexts) {
+    block k[MultiKeyLanes], c[MultiKeyLanes];
+    for (uint64_t i = 0; i < MultiKeyLanes; ++i) {
+        k[i] = keys[i];
+#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
+        c[i] = _mm_xor_si128(plaintexts[i], k[i]);
+#elif defined(HARDWARE_ACCELERATION_ARM_NEON_AES)
+        c[i] = plaintexts[i];
+#endif
+    }
+
+    multi_key_round<0x01, false>(k, c);
+    multi_key_round<0x02, false>(k, c);
+    multi_key_round<0x04, false>(k, c);
+    multi_key_round<0x08, false>(k, c);
+    multi_key_round<0x10, false>(k, c);
+    multi_key_round<0x20, false>(k, c);
+    multi_key_round<0x40, false>(k, c);
+    multi_key_round<0x80, false>(k, c);
+    multi_key_round<0x1B, false>(k, c);
+    multi_key_round<0x36, true>(k, c);
+
+    for (uint64_t i = 0; i < MultiKeyLanes; ++i)
+        ciphertexts[i] = c[i];
+}
+
+// Encrypts the N blocks input(i), ..., input(i + N - 1) to out[i], ...
+// Interleaving the N independent blocks hides the latency of the AES
+// instructions.
+template <uint64_t N, typename Input>
+inline void ecb_encrypt_batch(const block *round_keys, uint64_t i, Input input, block *out) {
+    block b[N];
+#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
+    for (uint64_t j = 0; j < N; ++j)
+        b[j] = _mm_xor_si128(input(i + j), round_keys[0]);
+    for (int r = 1; r < 10; ++r)
+        for (uint64_t j = 0; j < N; ++j)
+            b[j] = _mm_aesenc_si128(b[j], round_keys[r]);
+    for (uint64_t j = 0; j < N; ++j)
+        out[i + j] = _mm_aesenclast_si128(b[j], round_keys[10]);
+#elif defined(HARDWARE_ACCELERATION_ARM_NEON_AES)
+    for (uint64_t j = 0; j < N; ++j)
+        b[j] = input(i + j);
+    for (int r = 0; r < 9; ++r)
+        for (uint64_t j = 0; j < N; ++j)
+            b[j] = vaesmcq_u8(vaeseq_u8(b[j], round_keys[r]));
+    for (uint64_t j = 0; j < N; ++j)
+        out[i + j] = veorq_u8(vaeseq_u8(b[j], round_keys[9]), round_keys[10]);
+#endif
+}
+
+// Encrypts input(0), ..., input(length - 1) to out, 8 blocks at a time.
+// The single pipelined kernel behind ecbEncBlocks and ecbEncCounterMode.
+template <typename Input>
+inline void ecb_encrypt_pipelined(const block *round_keys, uint64_t length, Input input, block *out) {
+    constexpr uint64_t Pipeline = 8;
+
+    uint64_t i = 0;
+    for (; i + Pipeline <= length; i += Pipeline)
+        ecb_encrypt_batch<Pipeline>(round_keys, i, input, out);
+    for (; i < length; ++i)
+        ecb_encrypt_batch<1>(round_keys, i, input, out);
+}
+
 AES::AES(block key) {
     round_keys[0]  = key;
     round_keys[1]  = aes_128_key_expansion<0x01>(round_keys[0]);
@@ -84,18 +193,38 @@ AES::AES(block key) {
         return ciphertext;
     }
 
+    void AES::ecbEncBlocks(const block *plaintexts, uint64_t blockLength, block *ciphertexts) const
+    {
+        ecb_encrypt_pipelined(round_keys, blockLength,
+            [plaintexts](uint64_t i) { return plaintexts[i]; }, ciphertexts);
+    }
+
     void AES::ecbEncCounterMode(uint64_t baseIdx, uint64_t blockLength, block *ciphertext) const
     {
-        for (uint64_t i = 0; i < blockLength; ++i)
-        {
-            uint64_t counter = baseIdx + i;
+        // the counters are built in registers rather than stored first.
+        ecb_encrypt_pipelined(round_keys, blockLength,
+            [baseIdx](uint64_t i) { return toBlock(baseIdx + i, baseIdx + i); }, ciphertext);
+    }
 
-#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
-            block input = _mm_set1_epi64x(counter);
-#elif defined(HARDWARE_ACCELERATION_ARM_NEON_AES)
-            block input = vdupq_n_u64(counter);
-#endif
-            ciphertext[i] = ecbEncBlock(input);
+    void AES::ecbEncMultiKey(const block *keys, const block *plaintexts, block *ciphertexts, uint64_t length)
+    {
+        uint64_t i = 0;
+        for (; i + MultiKeyLanes <= length; i += MultiKeyLanes)
+            multi_key_encrypt(keys + i, plaintexts + i, ciphertexts + i);
+
+        if (i < length)
+        {
+            // pad the last batch with zero keys so that the rounds stay unrolled.
+            uint64_t n = length - i;
+            block k[MultiKeyLanes], p[MultiKeyLanes], c[MultiKeyLanes];
+            for (uint64_t j = 0; j < MultiKeyLanes; ++j)
+            {
+                k[j] = j < n ? keys[i + j] : ZeroBlock;
+                p[j] = j < n ? plaintexts[i + j] : ZeroBlock;
+            }
+            multi_key_encrypt(k, p, c);
+            for (uint64_t j = 0; j < n; ++j)
+                ciphertexts[i + j] = c[j];
         }
     }
 
@@ -0,0 +1,180 @@
+#include "simdcrypt/BlockAllocator.hpp"
+#include <algorithm>
+
+#if defined(__linux__) || defined(__APPLE__)
+  #include <sys/mman.h>
+  #define SIMDCRYPT_HAS_MMAP
+#endif
+
+#if defined(__linux__)
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace simdcrypt {
+
+namespace {
+
+    // size of a (transparent) huge page on x86-64 and most aarch64 kernels.
+    constexpr size_t HugePageSize = size_t(2) << 20;
+
+    // mbind(2) policy allocating on the node of the faulting CPU, from
+    // <linux/mempolicy.h>.
+    constexpr int MpolLocal = 4;
+
+    // MAP_HUGE_2MB from <linux/mman.h>: log2 of the page size in the bits
+    // from MAP_HUGE_SHIFT. Without it MAP_HUGETLB uses the default huge
+    // page size, e.g. 1 GB, which chunks are not rounded up to.
+    constexpr int MapHuge2MB = 21 << 26;
+
+    size_t roundUp(size_t size, size_t multiple)
+    {
+        return (size + multiple - 1) / multiple * multiple;
+    }
+
+#ifdef SIMDCRYPT_HAS_MMAP
+    void* mapAnonymous(size_t size, int extraFlags)
+    {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    // maps size bytes aligned to alignment by over mapping and unmapping
+    // the excess at both ends.
+    uint8_t* mapAligned(size_t size, size_t alignment)
+    {
+        auto raw = static_cast<uint8_t*>(mapAnonymous(size + alignment, 0));
+        if (!raw)
+            return nullptr;
+
+        auto aligned = reinterpret_cast<uint8_t*>(roundUp(reinterpret_cast<uintptr_t>(raw), alignment));
+        if (aligned != raw)
+            munmap(raw, aligned - raw);
+        size_t tail = (raw + size + alignment) - (aligned + size);
+        if (tail)
+            munmap(aligned + size, tail);
+        return aligned;
+    }
+#endif
+
+} // namespace
+
+    BlockArena::BlockArena(size_t chunkSize, HugePages hugePages, bool numaLocal)
+        :
+        mChunkSize(roundUp(std::max<size_t>(chunkSize, 1), Alignment)),
+        mHugePages(hugePages),
+        mNumaLocal(numaLocal)
+    {
+    }
+
+    BlockArena::~BlockArena()
+    {
+        release();
+    }
+
+    BlockArena::Chunk BlockArena::mapChunk(size_t size) const
+    {
+#ifdef SIMDCRYPT_HAS_MMAP
+        uint8_t* data = nullptr;
+
+  #ifdef __linux__
+        if (mHugePages != HugePages::None)
+            size = roundUp(size, HugePageSize);
+
+        if (mHugePages == HugePages::Explicit)
+            data = static_cast<uint8_t*>(mapAnonymous(size, MAP_HUGETLB | MapHuge2MB));
+
+        if (!data && mHugePages != HugePages::None)
+        {
+            // transparent huge pages are only used for 2 MB aligned ranges.
+            data = mapAligned(size, HugePageSize);
+            if (data)
+                madvise(data, size, MADV_HUGEPAGE);
+        }
+  #endif
+
+        if (!data)
+            data = static_cast<uint8_t*>(mapAnonymous(size, 0));
+        if (!data)
+            throw std::bad_alloc();
+
+  #ifdef __linux__
+        // best effort, this overrides e.g. an interleaved process policy
+        // so that pages are placed on the node of the thread touching them.
+        if (mNumaLocal)
+            syscall(SYS_mbind, data, size, MpolLocal, nullptr, 0, 0);
+  #endif
+
+        return { data, size };
+#else
+        return { static_cast<uint8_t*>(::operator new(size, std::align_val_t(Alignment))), size };
+#endif
+    }
+
+    void BlockArena::unmapChunk(const Chunk& chunk) const
+    {
+#ifdef SIMDCRYPT_HAS_MMAP
+        munmap(chunk.mData, chunk.mSize);
+#else
+        ::operator delete(chunk.mData, std::align_val_t(Alignment));
+#endif
+    }
+
+    void* BlockArena::allocate(size_t size)
+    {
+        size = roundUp(std::max<size_t>(size, 1), Alignment);
+
+        while (mCurrent < mChunks.size() && mOffset + size > mChunks[mCurrent].mSize)
+        {
+            ++mCurrent;
+            mOffset = 0;
+        }
+
+        if (mCurrent == mChunks.size())
+        {
+            mChunks.push_back(mapChunk(std::max(size, mChunkSize)));
+            mOffset = 0;
+        }
+
+        mLast = mChunks[mCurrent].mData + mOffset;
+        mOffset += size;
+        mUsed += size;
+        return mLast;
+    }
+
+    void BlockArena::deallocate(void* ptr, size_t size)
+    {
+        if (ptr && ptr == mLast)
+        {
+            size = roundUp(std::max<size_t>(size, 1), Alignment);
+            mOffset -= size;
+            mUsed -= size;
+            mLast = nullptr;
+        }
+    }
+
+    void BlockArena::reset()
+    {
+        mCurrent = 0;
+        mOffset = 0;
+        mLast = nullptr;
+        mUsed = 0;
+    }
+
+    void BlockArena::release()
+    {
+        for (auto& chunk : mChunks)
+            unmapChunk(chunk);
+        mChunks.clear();
+        reset();
+    }
+
+    size_t BlockArena::capacity() const
+    {
+        size_t total = 0;
+        for (auto& chunk : mChunks)
+            total += chunk.mSize;
+        return total;
+    }
+
+} // namespace simdcrypt
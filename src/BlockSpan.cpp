@@ -0,0 +1,165 @@
+#include "simdcrypt/BlockSpan.hpp"
+#include "BlockSpanKernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace simdcrypt {
+
+namespace detail {
+
+#ifdef HARDWARE_ACCELERATION_INTEL_AESNI
+
+    const BlockKernels baselineKernels = BulkOps<Sse2, Sse2>::kernels();
+
+#else
+
+namespace {
+
+    struct Neon
+    {
+        typedef uint8x16_t vec;
+        static constexpr size_t Blocks = 1;
+        static constexpr size_t Bytes = 16;
+
+        static vec load(const uint8_t* p) { return vld1q_u8(p); }
+        static void store(uint8_t* p, vec v) { vst1q_u8(p, v); }
+        static void storeu(uint8_t* p, vec v) { vst1q_u8(p, v); }
+        // NEON has no non-temporal hint for single vector stores.
+        static void stream(uint8_t* p, vec v) { vst1q_u8(p, v); }
+        static void fence() {}
+
+        static vec zero() { return vdupq_n_u8(0); }
+        static vec xor_(vec a, vec b) { return veorq_u8(a, b); }
+        static vec and_(vec a, vec b) { return vandq_u8(a, b); }
+        static vec or_(vec a, vec b) { return vorrq_u8(a, b); }
+        static vec select(vec m, vec a, vec b) { return vbslq_u8(m, b, a); }
+
+        static vec bitMask(const uint8_t* bits, size_t i)
+        {
+            return vdupq_n_u8(static_cast<uint8_t>(-static_cast<int>(getBit(bits, i))));
+        }
+
+        static bool isZero(vec v) { return vmaxvq_u8(v) == 0; }
+
+        static uint64_t popcount(vec v) { return vaddlvq_u8(vcntq_u8(v)); }
+
+        static vec popcountAdd(vec counts, vec v)
+        {
+            uint64x2_t c = vpadalq_u32(vreinterpretq_u64_u8(counts), vpaddlq_u16(vpaddlq_u8(vcntq_u8(v))));
+            return vreinterpretq_u8_u64(c);
+        }
+
+        static uint64_t sum(vec counts) { return vaddvq_u64(vreinterpretq_u64_u8(counts)); }
+    };
+
+} // namespace
+
+    const BlockKernels baselineKernels = BulkOps<Neon, Neon>::kernels();
+
+#endif
+
+} // namespace detail
+
+namespace {
+
+    SimdLevel supportedSimdLevel()
+    {
+#if defined(SIMDCRYPT_BLOCKSPAN_X86) && defined(__GNUC__)
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+#endif
+        return SimdLevel::Baseline;
+    }
+
+    const detail::BlockKernels* kernelsFor(SimdLevel level)
+    {
+        switch (level)
+        {
+#ifdef SIMDCRYPT_BLOCKSPAN_X86
+        case SimdLevel::AVX512:
+            return &detail::avx512Kernels;
+        case SimdLevel::AVX2:
+            return &detail::avx2Kernels;
+#endif
+        default:
+            return &detail::baselineKernels;
+        }
+    }
+
+    std::atomic<SimdLevel>& currentLevel()
+    {
+        static std::atomic<SimdLevel> level{ supportedSimdLevel() };
+        return level;
+    }
+
+    const detail::BlockKernels& kernels()
+    {
+        return *kernelsFor(currentLevel().load(std::memory_order_relaxed));
+    }
+
+    const uint8_t* bytes(ConstBlockSpan s) { return reinterpret_cast<const uint8_t*>(s.data()); }
+    uint8_t* bytes(BlockSpan s) { return reinterpret_cast<uint8_t*>(s.data()); }
+
+    void checkSize(size_t expected, size_t size)
+    {
+        if (size != expected)
+            throw std::runtime_error("block spans must have the same size");
+    }
+
+} // namespace
+
+    SimdLevel getSimdLevel()
+    {
+        return currentLevel().load(std::memory_order_relaxed);
+    }
+
+    SimdLevel setSimdLevel(SimdLevel level)
+    {
+        level = std::min(level, supportedSimdLevel());
+        currentLevel().store(level, std::memory_order_relaxed);
+        return level;
+    }
+
+    void xorBlocks(ConstBlockSpan a, ConstBlockSpan b, BlockSpan dest)
+    {
+        checkSize(a.size(), b.size());
+        checkSize(a.size(), dest.size());
+        kernels().xorBlocks(bytes(a), bytes(b), bytes(dest), a.size());
+    }
+
+    void andBlocks(ConstBlockSpan a, ConstBlockSpan b, BlockSpan dest)
+    {
+        checkSize(a.size(), b.size());
+        checkSize(a.size(), dest.size());
+        kernels().andBlocks(bytes(a), bytes(b), bytes(dest), a.size());
+    }
+
+    void selectBlocks(ConstBlockSpan mask, ConstBlockSpan a, ConstBlockSpan b, BlockSpan dest)
+    {
+        checkSize(a.size(), mask.size());
+        checkSize(a.size(), b.size());
+        checkSize(a.size(), dest.size());
+        kernels().selectBlocks(bytes(mask), bytes(a), bytes(b), bytes(dest), a.size());
+    }
+
+    void andBits(const uint8_t* bits, ConstBlockSpan a, BlockSpan dest)
+    {
+        checkSize(a.size(), dest.size());
+        kernels().andBits(bits, bytes(a), bytes(dest), a.size());
+    }
+
+    bool equalBlocks(ConstBlockSpan a, ConstBlockSpan b)
+    {
+        checkSize(a.size(), b.size());
+        return kernels().equalBlocks(bytes(a), bytes(b), a.size());
+    }
+
+    uint64_t hammingWeight(ConstBlockSpan a)
+    {
+        return kernels().hammingWeight(bytes(a), a.size());
+    }
+
+} // namespace simdcrypt
@@ -0,0 +1,60 @@
+// Compiled with -mavx2, see BlockSpanKernels.hpp.
+#include "BlockSpanKernels.hpp"
+#include <immintrin.h>
+
+namespace simdcrypt::detail {
+
+namespace {
+
+    struct Avx2
+    {
+        typedef __m256i vec;
+        static constexpr size_t Blocks = 2;
+        static constexpr size_t Bytes = 32;
+
+        static vec load(const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static void store(uint8_t* p, vec v) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), v); }
+        static void storeu(uint8_t* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        static void stream(uint8_t* p, vec v) { _mm256_stream_si256(reinterpret_cast<__m256i*>(p), v); }
+        static void fence() { _mm_sfence(); }
+
+        static vec zero() { return _mm256_setzero_si256(); }
+        static vec xor_(vec a, vec b) { return _mm256_xor_si256(a, b); }
+        static vec and_(vec a, vec b) { return _mm256_and_si256(a, b); }
+        static vec or_(vec a, vec b) { return _mm256_or_si256(a, b); }
+        static vec select(vec m, vec a, vec b) { return _mm256_xor_si256(a, _mm256_and_si256(m, _mm256_xor_si256(a, b))); }
+
+        static vec bitMask(const uint8_t* bits, size_t i)
+        {
+            int64_t b0 = -static_cast<int64_t>(getBit(bits, i));
+            int64_t b1 = -static_cast<int64_t>(getBit(bits, i + 1));
+            return _mm256_set_epi64x(b1, b1, b0, b0);
+        }
+
+        static bool isZero(vec v) { return _mm256_testz_si256(v, v); }
+
+        // per byte popcount through a nibble lookup table, summed into
+        // the four 64 bit lanes.
+        static vec popcountAdd(vec counts, vec v)
+        {
+            const vec lut = _mm256_setr_epi8(
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const vec low = _mm256_set1_epi8(0x0f);
+            vec lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low));
+            vec hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+            return _mm256_add_epi64(counts, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+        }
+
+        static uint64_t sum(vec counts)
+        {
+            __m128i s = _mm_add_epi64(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+            return static_cast<uint64_t>(_mm_cvtsi128_si64(s) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(s, s)));
+        }
+    };
+
+} // namespace
+
+    const BlockKernels avx2Kernels = BulkOps<Avx2, Sse2>::kernels();
+
+} // namespace simdcrypt::detail
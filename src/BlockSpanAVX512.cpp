@@ -0,0 +1,71 @@
+// Compiled with -mavx512f -mavx512bw, see BlockSpanKernels.hpp.
+#include "BlockSpanKernels.hpp"
+#include <immintrin.h>
+
+namespace simdcrypt::detail {
+
+namespace {
+
+    struct Avx512
+    {
+        typedef __m512i vec;
+        static constexpr size_t Blocks = 4;
+        static constexpr size_t Bytes = 64;
+
+        static vec load(const uint8_t* p) { return _mm512_loadu_si512(p); }
+        static void store(uint8_t* p, vec v) { _mm512_store_si512(p, v); }
+        static void storeu(uint8_t* p, vec v) { _mm512_storeu_si512(p, v); }
+        static void stream(uint8_t* p, vec v) { _mm512_stream_si512(reinterpret_cast<__m512i*>(p), v); }
+        static void fence() { _mm_sfence(); }
+
+        static vec zero() { return _mm512_setzero_si512(); }
+        static vec xor_(vec a, vec b) { return _mm512_xor_si512(a, b); }
+        static vec and_(vec a, vec b) { return _mm512_and_si512(a, b); }
+        static vec or_(vec a, vec b) { return _mm512_or_si512(a, b); }
+
+        // 0xCA is the truth table of m ? b : a.
+        static vec select(vec m, vec a, vec b) { return _mm512_ternarylogic_epi64(m, b, a, 0xCA); }
+
+        static vec bitMask(const uint8_t* bits, size_t i)
+        {
+            // every block spans two 64 bit lanes, so each bit is used twice.
+            __mmask8 k = 0;
+            for (size_t j = 0; j < Blocks; ++j)
+                k |= static_cast<__mmask8>(getBit(bits, i + j) * 3) << (2 * j);
+            return _mm512_maskz_set1_epi64(k, -1);
+        }
+
+        static bool isZero(vec v) { return _mm512_test_epi64_mask(v, v) == 0; }
+
+        // per byte popcount through a nibble lookup table, summed into
+        // the eight 64 bit lanes.
+        static vec popcountAdd(vec counts, vec v)
+        {
+            const vec lut = _mm512_set_epi64(
+                0x0403030203020201, 0x0302020102010100, 0x0403030203020201, 0x0302020102010100,
+                0x0403030203020201, 0x0302020102010100, 0x0403030203020201, 0x0302020102010100);
+            const vec low = _mm512_set1_epi8(0x0f);
+            vec lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(v, low));
+            vec hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(v, 4), low));
+            return _mm512_add_epi64(counts, _mm512_sad_epu8(_mm512_add_epi8(lo, hi), _mm512_setzero_si512()));
+        }
+
+        // GCC 12 implements _mm512_reduce_add_epi64 and the 512 to 256 bit
+        // extracts with undefined vectors and warns about them, so the
+        // lanes go through memory. This runs once per call.
+        static uint64_t sum(vec counts)
+        {
+            alignas(64) uint64_t lanes[8];
+            _mm512_store_si512(lanes, counts);
+            uint64_t total = 0;
+            for (auto lane : lanes)
+                total += lane;
+            return total;
+        }
+    };
+
+} // namespace
+
+    const BlockKernels avx512Kernels = BulkOps<Avx512, Sse2>::kernels();
+
+} // namespace simdcrypt::detail
@@ -0,0 +1,217 @@
+#pragma once
+// Internal to the library. Generic loops for the bulk block operations of
+// BlockSpan.hpp, instantiated once per instruction set.
+//
+// The AVX2 and AVX-512 translation units are compiled with the matching
+// -m flags, so they must not include AES.hpp or otherwise instantiate
+// inline functions shared with the rest of the library. Otherwise the
+// linker may keep the AVX copy and use it on CPUs without AVX.
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64) || defined(__x86_64__) || defined(__amd64) || defined(__amd64__)
+  #define SIMDCRYPT_BLOCKSPAN_X86
+  #include <emmintrin.h>
+#endif
+
+namespace simdcrypt::detail
+{
+    // Kernels operate on n blocks of 16 bytes each.
+    struct BlockKernels
+    {
+        void (*xorBlocks)(const uint8_t* a, const uint8_t* b, uint8_t* dest, size_t n);
+        void (*andBlocks)(const uint8_t* a, const uint8_t* b, uint8_t* dest, size_t n);
+        void (*selectBlocks)(const uint8_t* mask, const uint8_t* a, const uint8_t* b, uint8_t* dest, size_t n);
+        void (*andBits)(const uint8_t* bits, const uint8_t* a, uint8_t* dest, size_t n);
+        bool (*equalBlocks)(const uint8_t* a, const uint8_t* b, size_t n);
+        uint64_t (*hammingWeight)(const uint8_t* a, size_t n);
+    };
+
+    extern const BlockKernels baselineKernels;
+#ifdef SIMDCRYPT_BLOCKSPAN_X86
+    extern const BlockKernels avx2Kernels;
+    extern const BlockKernels avx512Kernels;
+#endif
+
+    // outputs of at least this many bytes are written with non-temporal
+    // stores, as they would not fit in the last level cache anyway.
+    constexpr size_t NonTemporalThreshold = size_t(1) << 24;
+
+    constexpr size_t BlockBytes = 16;
+
+    // static for the reason given at the top of this file.
+    static inline uint64_t getBit(const uint8_t* bits, size_t i)
+    {
+        return (bits[i / 8] >> (i % 8)) & 1;
+    }
+
+    // W is the wide vector type, processing W::Blocks blocks at a time and
+    // S the 128 bit one used for the unaligned head and the tail. Both
+    // provide load, storeu, zero, xor_, and_, or_, select, bitMask and
+    // isZero. S also provides popcount, W provides store, stream, fence,
+    // popcountAdd and sum.
+    template <class W, class S>
+    struct BulkOps
+    {
+        // Writes single(i) or wide(i) to block i of dest, for all i < n.
+        template <class Single, class Wide>
+        static void forEachBlock(uint8_t* dest, size_t n, Single single, Wide wide)
+        {
+            size_t i = 0;
+            while (i < n && i + 1 < W::Blocks && reinterpret_cast<uintptr_t>(dest + i * BlockBytes) % W::Bytes)
+            {
+                S::storeu(dest + i * BlockBytes, single(i));
+                ++i;
+            }
+
+            bool aligned = reinterpret_cast<uintptr_t>(dest + i * BlockBytes) % W::Bytes == 0;
+            if (aligned && n * BlockBytes >= NonTemporalThreshold)
+            {
+                for (; i + W::Blocks <= n; i += W::Blocks)
+                    W::stream(dest + i * BlockBytes, wide(i));
+                W::fence();
+            }
+            else if (aligned)
+            {
+                for (; i + W::Blocks <= n; i += W::Blocks)
+                    W::store(dest + i * BlockBytes, wide(i));
+            }
+            else
+            {
+                for (; i + W::Blocks <= n; i += W::Blocks)
+                    W::storeu(dest + i * BlockBytes, wide(i));
+            }
+
+            for (; i < n; ++i)
+                S::storeu(dest + i * BlockBytes, single(i));
+        }
+
+        static void xorBlocks(const uint8_t* a, const uint8_t* b, uint8_t* dest, size_t n)
+        {
+            forEachBlock(dest, n,
+                [=](size_t i) { return S::xor_(S::load(a + i * BlockBytes), S::load(b + i * BlockBytes)); },
+                [=](size_t i) { return W::xor_(W::load(a + i * BlockBytes), W::load(b + i * BlockBytes)); });
+        }
+
+        static void andBlocks(const uint8_t* a, const uint8_t* b, uint8_t* dest, size_t n)
+        {
+            forEachBlock(dest, n,
+                [=](size_t i) { return S::and_(S::load(a + i * BlockBytes), S::load(b + i * BlockBytes)); },
+                [=](size_t i) { return W::and_(W::load(a + i * BlockBytes), W::load(b + i * BlockBytes)); });
+        }
+
+        static void selectBlocks(const uint8_t* mask, const uint8_t* a, const uint8_t* b, uint8_t* dest, size_t n)
+        {
+            forEachBlock(dest, n,
+                [=](size_t i) {
+                    return S::select(S::load(mask + i * BlockBytes), S::load(a + i * BlockBytes), S::load(b + i * BlockBytes));
+                },
+                [=](size_t i) {
+                    return W::select(W::load(mask + i * BlockBytes), W::load(a + i * BlockBytes), W::load(b + i * BlockBytes));
+                });
+        }
+
+        static void andBits(const uint8_t* bits, const uint8_t* a, uint8_t* dest, size_t n)
+        {
+            forEachBlock(dest, n,
+                [=](size_t i) { return S::and_(S::bitMask(bits, i), S::load(a + i * BlockBytes)); },
+                [=](size_t i) { return W::and_(W::bitMask(bits, i), W::load(a + i * BlockBytes)); });
+        }
+
+        static bool equalBlocks(const uint8_t* a, const uint8_t* b, size_t n)
+        {
+            // check for a difference once per chunk so that unequal
+            // inputs return early without slowing down the inner loop.
+            constexpr size_t Chunk = 64 * W::Blocks;
+            size_t i = 0;
+            while (i + W::Blocks <= n)
+            {
+                size_t end = i + Chunk <= n ? i + Chunk : n - (n - i) % W::Blocks;
+                auto diff = W::zero();
+                for (; i < end; i += W::Blocks)
+                    diff = W::or_(diff, W::xor_(W::load(a + i * BlockBytes), W::load(b + i * BlockBytes)));
+                if (!W::isZero(diff))
+                    return false;
+            }
+
+            auto diff = S::zero();
+            for (; i < n; ++i)
+                diff = S::or_(diff, S::xor_(S::load(a + i * BlockBytes), S::load(b + i * BlockBytes)));
+            return S::isZero(diff);
+        }
+
+        static uint64_t hammingWeight(const uint8_t* a, size_t n)
+        {
+            // W::popcountAdd accumulates into 64 bit lanes, which are
+            // only summed up at the end.
+            auto counts = W::zero();
+            size_t i = 0;
+            for (; i + W::Blocks <= n; i += W::Blocks)
+                counts = W::popcountAdd(counts, W::load(a + i * BlockBytes));
+
+            uint64_t weight = W::sum(counts);
+            for (; i < n; ++i)
+                weight += S::popcount(S::load(a + i * BlockBytes));
+            return weight;
+        }
+
+        static constexpr BlockKernels kernels()
+        {
+            return { xorBlocks, andBlocks, selectBlocks, andBits, equalBlocks, hammingWeight };
+        }
+    };
+
+#ifdef SIMDCRYPT_BLOCKSPAN_X86
+namespace {
+
+    // 128 bit SSE2 operations. Used as the baseline on x86 and for the
+    // head and tail of the wider kernels.
+    struct Sse2
+    {
+        typedef __m128i vec;
+        static constexpr size_t Blocks = 1;
+        static constexpr size_t Bytes = 16;
+
+        static vec load(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        static void store(uint8_t* p, vec v) { _mm_store_si128(reinterpret_cast<__m128i*>(p), v); }
+        static void storeu(uint8_t* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        static void stream(uint8_t* p, vec v) { _mm_stream_si128(reinterpret_cast<__m128i*>(p), v); }
+        static void fence() { _mm_sfence(); }
+
+        static vec zero() { return _mm_setzero_si128(); }
+        static vec xor_(vec a, vec b) { return _mm_xor_si128(a, b); }
+        static vec and_(vec a, vec b) { return _mm_and_si128(a, b); }
+        static vec or_(vec a, vec b) { return _mm_or_si128(a, b); }
+        static vec select(vec m, vec a, vec b) { return _mm_xor_si128(a, _mm_and_si128(m, _mm_xor_si128(a, b))); }
+
+        static vec bitMask(const uint8_t* bits, size_t i)
+        {
+            return _mm_set1_epi64x(-static_cast<int64_t>(getBit(bits, i)));
+        }
+
+        static bool isZero(vec v)
+        {
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+        }
+
+        static uint64_t popcount(vec v)
+        {
+            return __builtin_popcountll(static_cast<uint64_t>(_mm_cvtsi128_si64(v))) +
+                __builtin_popcountll(static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v))));
+        }
+
+        static vec popcountAdd(vec counts, vec v)
+        {
+            return _mm_add_epi64(counts, _mm_cvtsi64_si128(static_cast<int64_t>(popcount(v))));
+        }
+
+        static uint64_t sum(vec counts)
+        {
+            return static_cast<uint64_t>(_mm_cvtsi128_si64(counts));
+        }
+    };
+
+} // namespace
+#endif
+
+} // namespace simdcrypt::detail
@@ -0,0 +1,489 @@
+#include "simdcrypt/CtrDrbg.hpp"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <stdexcept>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace simdcrypt {
+
+namespace {
+
+    std::atomic<uint64_t> gNextId{ 1 };
+
+    // Incremented in the child of every fork(). Instances and thread local
+    // buffers remember the generation they were last used in, so that the
+    // state a child inherits from its parent is never used as is.
+    std::atomic<uint64_t> gForkGeneration{ 0 };
+
+#if defined(__linux__) || defined(__APPLE__)
+    void onForkChild()
+    {
+        gForkGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool registerForkHandler()
+    {
+        static const bool registered = pthread_atfork(nullptr, nullptr, onForkChild) == 0;
+        return registered;
+    }
+
+    uint64_t processId()
+    {
+        return uint64_t(getpid());
+    }
+#else
+    bool registerForkHandler()
+    {
+        return true;
+    }
+
+    uint64_t processId()
+    {
+        return 0;
+    }
+#endif
+
+    // Output of the last request this thread reserved. Bytes are wiped
+    // once they have been handed out.
+    struct LocalBuffer
+    {
+        uint64_t mOwner = 0;
+        uint64_t mGeneration = 0;
+        size_t mBytesIdx = CtrDrbg::RequestBytes;
+        alignas(64) uint8_t mData[CtrDrbg::RequestBytes];
+    };
+
+    thread_local LocalBuffer tLocal;
+
+    uint64_t byteswap(uint64_t x)
+    {
+        x = ((x & 0x00FF00FF00FF00FFull) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFull);
+        x = ((x & 0x0000FFFF0000FFFFull) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFull);
+        return (x << 32) | (x >> 32);
+    }
+
+    // V is a big endian 128 bit integer, v[0] being the high word.
+    block counterBlock(const uint64_t v[2])
+    {
+        return toBlock(byteswap(v[1]), byteswap(v[0]));
+    }
+
+    void addCounter(uint64_t v[2], uint64_t x)
+    {
+        v[1] += x;
+        if (v[1] < x)
+            ++v[0];
+    }
+
+    // zeroes memory holding secrets before it goes out of scope, through a
+    // volatile pointer so that the stores are not elided.
+    void wipe(void* ptr, size_t length)
+    {
+        volatile uint8_t* p = static_cast<volatile uint8_t*>(ptr);
+        for (size_t i = 0; i < length; ++i)
+            p[i] = 0;
+    }
+
+    std::array<uint8_t, CtrDrbg::SeedLength> randomDeviceEntropy()
+    {
+        std::array<uint8_t, CtrDrbg::SeedLength> entropy;
+        std::random_device rd;
+        for (size_t i = 0; i < entropy.size(); i += sizeof(uint32_t))
+        {
+            uint32_t x = rd();
+            memcpy(entropy.data() + i, &x, sizeof(x));
+        }
+        return entropy;
+    }
+
+} // namespace
+
+    CtrDrbg::CtrDrbg(const uint8_t* entropy,
+        const uint8_t* personalization, size_t personalizationLength,
+        EntropySource entropySource, bool predictionResistance,
+        uint64_t reseedInterval, uint64_t epochRequests)
+        :
+        mId(gNextId.fetch_add(1)),
+        mEntropySource(std::move(entropySource)),
+        mPredictionResistance(predictionResistance),
+        mReseedInterval(std::clamp<uint64_t>(reseedInterval, 1, MaxReseedInterval)),
+        mEpochRequests(std::clamp<uint64_t>(epochRequests, 1, std::min(MaxEpochRequests, mReseedInterval)))
+    {
+        if (personalizationLength > SeedLength)
+            throw std::runtime_error("CtrDrbg personalization string is longer than the seed length");
+        if (mPredictionResistance && !mEntropySource)
+            throw std::runtime_error("CtrDrbg prediction resistance requires an entropy source");
+        if (!registerForkHandler())
+            throw std::runtime_error("CtrDrbg failed to register its fork handler");
+        mForkGeneration.store(gForkGeneration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        uint8_t seedMaterial[SeedLength];
+        memcpy(seedMaterial, entropy, SeedLength);
+        for (size_t i = 0; i < personalizationLength; ++i)
+            seedMaterial[i] ^= personalization[i];
+
+        mLatest.mKey = ZeroBlock;
+        mLatest.mV[0] = mLatest.mV[1] = 0;
+        update(mLatest, seedMaterial);
+        wipe(seedMaterial, sizeof(seedMaterial));
+
+        // with prediction resistance get(...) works on mLatest directly.
+        if (!mPredictionResistance)
+        {
+            publish(0, mLatest);
+            prepare(1, true);
+        }
+    }
+
+    CtrDrbg& CtrDrbg::global()
+    {
+        static CtrDrbg drbg(randomDeviceEntropy().data(), nullptr, 0,
+            [](uint8_t* dest, size_t length)
+            {
+                auto entropy = randomDeviceEntropy();
+                memcpy(dest, entropy.data(), std::min(length, entropy.size()));
+                return length <= entropy.size();
+            });
+        return drbg;
+    }
+
+    // CTR_DRBG_Update of SP 800-90A, section 10.2.1.2.
+    void CtrDrbg::update(State& state, const uint8_t* providedData)
+    {
+        AES aes(state.mKey);
+        block temp[2];
+        for (auto& t : temp)
+        {
+            addCounter(state.mV, 1);
+            t = aes.ecbEncBlock(counterBlock(state.mV));
+        }
+
+        if (providedData)
+        {
+            temp[0] = xor_blocks(temp[0], toBlock(providedData));
+            temp[1] = xor_blocks(temp[1], toBlock(providedData + sizeof(block)));
+        }
+
+        state.mKey = temp[0];
+        state.mV[0] = byteswap(extract_u64<0>(temp[1]));
+        state.mV[1] = byteswap(extract_u64<1>(temp[1]));
+
+        wipe(&aes, sizeof(aes));
+        wipe(temp, sizeof(temp));
+    }
+
+    // CTR_DRBG_Reseed, section 10.2.1.4.1.
+    void CtrDrbg::reseedState(State& state, const uint8_t* additionalInput, size_t additionalInputLength)
+    {
+        if (!mEntropySource)
+            throw std::runtime_error("CtrDrbg must be reseeded but has no entropy source");
+
+        uint8_t seedMaterial[SeedLength];
+        if (!mEntropySource(seedMaterial, SeedLength))
+            throw std::runtime_error("CtrDrbg entropy source failed");
+        for (size_t i = 0; i < additionalInputLength; ++i)
+            seedMaterial[i] ^= additionalInput[i];
+
+        update(state, seedMaterial);
+        wipe(seedMaterial, sizeof(seedMaterial));
+    }
+
+    bool CtrDrbg::readSlot(uint64_t epoch, State& state) const
+    {
+        const Slot& slot = mSlots[epoch % NumSlots];
+        if (slot.mEpoch.load(std::memory_order_acquire) != epoch)
+            return false;
+
+        uint64_t key0 = slot.mKey[0].load(std::memory_order_relaxed);
+        uint64_t key1 = slot.mKey[1].load(std::memory_order_relaxed);
+        state.mV[0] = slot.mV[0].load(std::memory_order_relaxed);
+        state.mV[1] = slot.mV[1].load(std::memory_order_relaxed);
+        state.mKey = toBlock(key1, key0);
+
+        // the slot may have been wiped or reused while we read it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.mEpoch.load(std::memory_order_relaxed) == epoch;
+    }
+
+    // Writes the state of epoch over that of epoch - NumSlots. Threads that
+    // reserved a request in the overwritten epoch but did not read it yet
+    // retry in a later one.
+    void CtrDrbg::publish(uint64_t epoch, const State& state)
+    {
+        Slot& slot = mSlots[epoch % NumSlots];
+        slot.mEpoch.store(~uint64_t(0), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.mKey[0].store(extract_u64<0>(state.mKey), std::memory_order_relaxed);
+        slot.mKey[1].store(extract_u64<1>(state.mKey), std::memory_order_relaxed);
+        slot.mV[0].store(state.mV[0], std::memory_order_relaxed);
+        slot.mV[1].store(state.mV[1], std::memory_order_relaxed);
+
+        slot.mEpoch.store(epoch, std::memory_order_release);
+    }
+
+    // Derives and publishes the state of the epoch after mLatestEpoch:
+    // the update that follows its last request, or a reseed once the
+    // reseed interval would be exceeded or if forced.
+    void CtrDrbg::prepareLocked(bool forceReseed, const uint8_t* additionalInput, size_t additionalInputLength)
+    {
+        State next = mLatest;
+        addCounter(next.mV, mEpochRequests * RequestBlocks);
+        update(next, nullptr);
+
+        uint64_t requests = mRequestsSinceReseed + mEpochRequests;
+        if (forceReseed || requests + mEpochRequests > mReseedInterval)
+        {
+            reseedState(next, additionalInput, additionalInputLength);
+            requests = 0;
+        }
+
+        mLatest = next;
+        mRequestsSinceReseed = requests;
+        mLatestEpoch = (mLatestEpoch + 1) & EpochMask;
+        wipe(&next, sizeof(next));
+
+        publish(mLatestEpoch, mLatest);
+    }
+
+    // Prepares epoch unless it already is. An eager preparation, made
+    // ahead of need, ignores errors: the thread that needs the epoch
+    // retries it and gets the error.
+    void CtrDrbg::prepare(uint64_t epoch, bool eager)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mLatestEpoch != ((epoch - 1) & EpochMask))
+            return;
+
+        try
+        {
+            prepareLocked(false, nullptr, 0);
+        }
+        catch (...)
+        {
+            if (!eager)
+                throw;
+        }
+    }
+
+    // Moves from epoch to the next one if epoch is still current. The next
+    // epoch normally has been prepared by the thread that started epoch,
+    // so this is a compare and swap. Whoever wins it prepares the epoch
+    // after.
+    void CtrDrbg::switchEpoch(uint64_t epoch)
+    {
+        uint64_t next = (epoch + 1) & EpochMask;
+        uint64_t state = mState.load(std::memory_order_relaxed);
+        while ((state >> RequestBits) == epoch)
+        {
+            if (mSlots[next % NumSlots].mEpoch.load(std::memory_order_acquire) != next)
+            {
+                prepare(next, false);
+                state = mState.load(std::memory_order_relaxed);
+            }
+            else if (mState.compare_exchange_weak(state, next << RequestBits,
+                std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                prepare((next + 1) & EpochMask, true);
+                return;
+            }
+        }
+    }
+
+    void CtrDrbg::reseed(const uint8_t* additionalInput, size_t additionalInputLength)
+    {
+        if (additionalInputLength > SeedLength)
+            throw std::runtime_error("CtrDrbg additional input is longer than the seed length");
+
+        // the bytes this thread buffered predate the reseed.
+        LocalBuffer& local = tLocal;
+        if (local.mOwner == mId)
+        {
+            wipe(local.mData, sizeof(local.mData));
+            local.mBytesIdx = RequestBytes;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        reseedLocked(additionalInput, additionalInputLength);
+    }
+
+    void CtrDrbg::reseedLocked(const uint8_t* additionalInput, size_t additionalInputLength)
+    {
+        if (mPredictionResistance)
+        {
+            reseedState(mLatest, additionalInput, additionalInputLength);
+            return;
+        }
+
+        // reseed the epoch after the current one, deriving it first if it
+        // was not prepared yet, then make it current.
+        uint64_t current = mState.load(std::memory_order_acquire) >> RequestBits;
+        uint64_t next = (current + 1) & EpochMask;
+        if (mLatestEpoch == current)
+            prepareLocked(true, additionalInput, additionalInputLength);
+        else
+        {
+            reseedState(mLatest, additionalInput, additionalInputLength);
+            mRequestsSinceReseed = 0;
+            publish(next, mLatest);
+        }
+
+        uint64_t state = mState.load(std::memory_order_relaxed);
+        while ((state >> RequestBits) == current &&
+            !mState.compare_exchange_weak(state, next << RequestBits,
+                std::memory_order_acq_rel, std::memory_order_relaxed))
+            ;
+
+        try
+        {
+            prepareLocked(false, nullptr, 0);
+        }
+        catch (...)
+        {
+            // retried by the thread that needs the epoch, as in prepare(...).
+        }
+    }
+
+    // The child of a fork() starts with a copy of its parent's state and
+    // would repeat its output, so it reseeds before generating anything.
+    // The process id is mixed in as additional input in case the entropy
+    // source was copied too.
+    void CtrDrbg::reseedAfterFork(uint64_t generation)
+    {
+        if (!mEntropySource)
+            throw std::runtime_error("CtrDrbg used after fork() without an entropy source to reseed from");
+
+        uint64_t pid = processId();
+        uint8_t additionalInput[sizeof(pid)];
+        memcpy(additionalInput, &pid, sizeof(pid));
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mForkGeneration.load(std::memory_order_relaxed) == generation)
+            return;
+        reseedLocked(additionalInput, sizeof(additionalInput));
+        mForkGeneration.store(generation, std::memory_order_release);
+    }
+
+    void CtrDrbg::generate(const State& state, uint64_t request, uint8_t* dest) const
+    {
+        uint64_t v[2] = { state.mV[0], state.mV[1] };
+        addCounter(v, request * RequestBlocks);
+
+        block* out = reinterpret_cast<block*>(dest);
+        for (size_t i = 0; i < RequestBlocks; ++i)
+        {
+            addCounter(v, 1);
+            out[i] = counterBlock(v);
+        }
+
+        AES aes(state.mKey);
+        aes.ecbEncBlocks(out, RequestBlocks, out);
+
+        wipe(&aes, sizeof(aes));
+        wipe(v, sizeof(v));
+    }
+
+    void CtrDrbg::refill(uint8_t* dest)
+    {
+        for (;;)
+        {
+            uint64_t reservation = mState.fetch_add(1, std::memory_order_acquire);
+            uint64_t epoch = reservation >> RequestBits;
+            uint64_t request = reservation & RequestMask;
+
+            if (request >= mEpochRequests)
+            {
+                switchEpoch(epoch);
+                continue;
+            }
+
+            State state;
+            bool valid = readSlot(epoch, state);
+            if (valid)
+                generate(state, request, dest);
+            wipe(&state, sizeof(state));
+            if (valid)
+                return;
+        }
+    }
+
+    // CTR_DRBG_Generate of SP 800-90A, section 10.2.1.5.1, with the reseed
+    // that prediction resistance requires before every generate. Nothing is
+    // buffered, the output goes straight to dest.
+    void CtrDrbg::generatePredictionResistant(uint8_t* dest, size_t length)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        block buffer[16];
+        while (length)
+        {
+            size_t step = std::min(length, MaxGenerateBytes);
+            reseedState(mLatest, nullptr, 0);
+
+            AES aes(mLatest.mKey);
+            for (size_t i = 0; i < step; i += sizeof(buffer))
+            {
+                size_t n = std::min(sizeof(buffer), step - i);
+                size_t blocks = (n + sizeof(block) - 1) / sizeof(block);
+                for (size_t j = 0; j < blocks; ++j)
+                {
+                    addCounter(mLatest.mV, 1);
+                    buffer[j] = counterBlock(mLatest.mV);
+                }
+                aes.ecbEncBlocks(buffer, blocks, buffer);
+                memcpy(dest + i, buffer, n);
+            }
+            update(mLatest, nullptr);
+            wipe(&aes, sizeof(aes));
+
+            dest += step;
+            length -= step;
+        }
+        wipe(buffer, sizeof(buffer));
+    }
+
+    void CtrDrbg::get(uint8_t* dest, size_t length)
+    {
+        uint64_t generation = gForkGeneration.load(std::memory_order_relaxed);
+        if (generation != mForkGeneration.load(std::memory_order_acquire))
+            reseedAfterFork(generation);
+
+        if (mPredictionResistance)
+        {
+            generatePredictionResistant(dest, length);
+            return;
+        }
+
+        LocalBuffer& local = tLocal;
+        if (local.mOwner != mId || local.mGeneration != generation)
+        {
+            memset(local.mData, 0, sizeof(local.mData));
+            local.mOwner = mId;
+            local.mGeneration = generation;
+            local.mBytesIdx = RequestBytes;
+        }
+
+        while (length)
+        {
+            if (local.mBytesIdx == RequestBytes)
+            {
+                refill(local.mData);
+                local.mBytesIdx = 0;
+            }
+
+            size_t step = std::min(length, RequestBytes - local.mBytesIdx);
+            memcpy(dest, local.mData + local.mBytesIdx, step);
+            memset(local.mData + local.mBytesIdx, 0, step);
+
+            dest += step;
+            length -= step;
+            local.mBytesIdx += step;
+        }
+    }
+
+} // namespace simdcrypt
@@ -4,8 +4,9 @@
 
 namespace simdcrypt {
 
-    PRNG::PRNG(const block& seed, uint64_t bufferSize)
+    PRNG::PRNG(const block& seed, uint64_t bufferSize, BlockVector::allocator_type allocator)
         :
+        mBuffer(allocator),
         mBytesIdx(0),
         mBlockIdx(0)
     {
@@ -0,0 +1,332 @@
+#include "simdcrypt/XTS.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace simdcrypt {
+
+namespace {
+
+    // number of blocks that are encrypted together to hide the latency
+    // of the AES instructions.
+    constexpr size_t Pipeline = 8;
+
+    // bytes per thread below which spawning threads is not worth it.
+    constexpr uint64_t MinBytesPerThread = 1 << 16;
+
+#ifdef HARDWARE_ACCELERATION_INTEL_AESNI
+
+    inline block aes_256_assist_1(block key, block keygened) {
+        keygened = _mm_shuffle_epi32(keygened, _MM_SHUFFLE(3,3,3,3));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        return _mm_xor_si128(key, keygened);
+    }
+
+    inline block aes_256_assist_2(block prev, block key) {
+        block keygened = _mm_aeskeygenassist_si128(prev, 0);
+        keygened = _mm_shuffle_epi32(keygened, _MM_SHUFFLE(2,2,2,2));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        return _mm_xor_si128(key, keygened);
+    }
+
+    template <int rcon>
+    inline block aes_256_rot_sub_word(block key) {
+        return _mm_aeskeygenassist_si128(key, rcon);
+    }
+
+    inline block inv_mix_columns(const block& key) {
+        return _mm_aesimc_si128(key);
+    }
+
+#else
+
+    // SubWord applied to the last word of key, broadcast to all lanes.
+    // If rotate is set, RotWord is applied as well and rcon is added.
+    inline block aes_256_sub_word(block key, bool rotate, uint8_t rcon) {
+        uint8x16_t temp = vaeseq_u8(key, vdupq_n_u8(0x00));
+        uint32_t t;
+        if (rotate)
+            t = (vgetq_lane_u8(temp, 9) ^ rcon)  |
+                (vgetq_lane_u8(temp, 6) << 8)  |
+                (vgetq_lane_u8(temp, 3) << 16) |
+                (vgetq_lane_u8(temp, 12) << 24);
+        else
+            t = (vgetq_lane_u8(temp, 12)) |
+                (vgetq_lane_u8(temp, 9) << 8)  |
+                (vgetq_lane_u8(temp, 6) << 16) |
+                (vgetq_lane_u8(temp, 3) << 24);
+        return vreinterpretq_u8_u32(vdupq_n_u32(t));
+    }
+
+    inline block aes_256_assist_1(block key, block keygened) {
+        key = veorq_u8(key, vextq_u8(vdupq_n_u8(0), key, 12));
+        key = veorq_u8(key, vextq_u8(vdupq_n_u8(0), key, 12));
+        key = veorq_u8(key, vextq_u8(vdupq_n_u8(0), key, 12));
+        return veorq_u8(key, keygened);
+    }
+
+    inline block aes_256_assist_2(block prev, block key) {
+        return aes_256_assist_1(key, aes_256_sub_word(prev, false, 0));
+    }
+
+    template <int rcon>
+    inline block aes_256_rot_sub_word(block key) {
+        return aes_256_sub_word(key, true, rcon);
+    }
+
+    inline block inv_mix_columns(const block& key) {
+        return vaesimcq_u8(key);
+    }
+
+#endif
+
+    void aes_256_key_expansion(block k0, block k1, block* rk) {
+        rk[0] = k0;
+        rk[1] = k1;
+        rk[2]  = aes_256_assist_1(rk[0], aes_256_rot_sub_word<0x01>(rk[1]));
+        rk[3]  = aes_256_assist_2(rk[2], rk[1]);
+        rk[4]  = aes_256_assist_1(rk[2], aes_256_rot_sub_word<0x02>(rk[3]));
+        rk[5]  = aes_256_assist_2(rk[4], rk[3]);
+        rk[6]  = aes_256_assist_1(rk[4], aes_256_rot_sub_word<0x04>(rk[5]));
+        rk[7]  = aes_256_assist_2(rk[6], rk[5]);
+        rk[8]  = aes_256_assist_1(rk[6], aes_256_rot_sub_word<0x08>(rk[7]));
+        rk[9]  = aes_256_assist_2(rk[8], rk[7]);
+        rk[10] = aes_256_assist_1(rk[8], aes_256_rot_sub_word<0x10>(rk[9]));
+        rk[11] = aes_256_assist_2(rk[10], rk[9]);
+        rk[12] = aes_256_assist_1(rk[10], aes_256_rot_sub_word<0x20>(rk[11]));
+        rk[13] = aes_256_assist_2(rk[12], rk[11]);
+        rk[14] = aes_256_assist_1(rk[12], aes_256_rot_sub_word<0x40>(rk[13]));
+    }
+
+    void aes_128_key_expansion(block k0, block* rk) {
+        AES aes(k0);
+        for (int i = 0; i <= 10; ++i)
+            rk[i] = aes.get_round_key(i);
+    }
+
+    // Encrypts N blocks in lock step so that the AES unit is kept busy.
+    template <size_t N>
+    inline void encrypt_blocks(const block* keys, int rounds, block* b) {
+#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
+        for (size_t i = 0; i < N; ++i)
+            b[i] = _mm_xor_si128(b[i], keys[0]);
+        for (int r = 1; r < rounds; ++r)
+            for (size_t i = 0; i < N; ++i)
+                b[i] = _mm_aesenc_si128(b[i], keys[r]);
+        for (size_t i = 0; i < N; ++i)
+            b[i] = _mm_aesenclast_si128(b[i], keys[rounds]);
+#elif defined(HARDWARE_ACCELERATION_ARM_NEON_AES)
+        for (int r = 0; r < rounds - 1; ++r)
+            for (size_t i = 0; i < N; ++i)
+                b[i] = vaesmcq_u8(vaeseq_u8(b[i], keys[r]));
+        for (size_t i = 0; i < N; ++i)
+            b[i] = veorq_u8(vaeseq_u8(b[i], keys[rounds - 1]), keys[rounds]);
+#endif
+    }
+
+    // Decrypts N blocks in lock step. keys are the equivalent inverse
+    // cipher round keys as produced in the AESXTS constructor.
+    template <size_t N>
+    inline void decrypt_blocks(const block* keys, int rounds, block* b) {
+#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
+        for (size_t i = 0; i < N; ++i)
+            b[i] = _mm_xor_si128(b[i], keys[0]);
+        for (int r = 1; r < rounds; ++r)
+            for (size_t i = 0; i < N; ++i)
+                b[i] = _mm_aesdec_si128(b[i], keys[r]);
+        for (size_t i = 0; i < N; ++i)
+            b[i] = _mm_aesdeclast_si128(b[i], keys[rounds]);
+#elif defined(HARDWARE_ACCELERATION_ARM_NEON_AES)
+        for (int r = 0; r < rounds - 1; ++r)
+            for (size_t i = 0; i < N; ++i)
+                b[i] = vaesimcq_u8(vaesdq_u8(b[i], keys[r]));
+        for (size_t i = 0; i < N; ++i)
+            b[i] = veorq_u8(vaesdq_u8(b[i], keys[rounds - 1]), keys[rounds]);
+#endif
+    }
+
+    template <size_t N>
+    inline void crypt_blocks(const block* encKeys, const block* decKeys, int rounds, bool encrypt, block* b) {
+        if (encrypt)
+            encrypt_blocks<N>(encKeys, rounds, b);
+        else
+            decrypt_blocks<N>(decKeys, rounds, b);
+    }
+
+} // namespace
+
+    AESXTS::AESXTS(const uint8_t* key, size_t keyLength)
+    {
+        if (keyLength == 32)
+        {
+            mRounds = 10;
+            aes_128_key_expansion(toBlock(key), mEncKeys);
+            aes_128_key_expansion(toBlock(key + 16), mTweakKeys);
+        }
+        else if (keyLength == 64)
+        {
+            mRounds = 14;
+            aes_256_key_expansion(toBlock(key), toBlock(key + 16), mEncKeys);
+            aes_256_key_expansion(toBlock(key + 32), toBlock(key + 48), mTweakKeys);
+        }
+        else
+            throw std::runtime_error("AES-XTS key must be 32 or 64 bytes");
+
+        mDecKeys[0] = mEncKeys[mRounds];
+        for (int i = 1; i < mRounds; ++i)
+            mDecKeys[i] = inv_mix_columns(mEncKeys[mRounds - i]);
+        mDecKeys[mRounds] = mEncKeys[0];
+    }
+
+    block AESXTS::mulAlpha(const block& tweak)
+    {
+        // Shift each 32 bit lane left by one and carry the top bit of
+        // every lane into the next one. The bit carried out of the top
+        // lane is reduced by x^128 = x^7 + x^2 + x + 1.
+#if defined(HARDWARE_ACCELERATION_INTEL_AESNI)
+        block carry = _mm_srai_epi32(tweak, 31);
+        carry = _mm_shuffle_epi32(carry, _MM_SHUFFLE(2,1,0,3));
+        carry = _mm_and_si128(carry, _mm_set_epi32(1, 1, 1, 0x87));
+        return _mm_xor_si128(_mm_slli_epi32(tweak, 1), carry);
+#elif defined(HARDWARE_ACCELERATION_ARM_NEON_AES)
+        static const uint32_t poly[4] = { 0x87, 1, 1, 1 };
+        uint32x4_t t = vreinterpretq_u32_u8(tweak);
+        uint32x4_t carry = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(t), 31));
+        carry = vandq_u32(vextq_u32(carry, carry, 3), vld1q_u32(poly));
+        return vreinterpretq_u8_u32(veorq_u32(vshlq_n_u32(t, 1), carry));
+#endif
+    }
+
+    void AESXTS::encryptSector(uint8_t* data, size_t sectorSize, uint64_t sectorIndex) const
+    {
+        processSectors(data, data, sectorSize, sectorIndex, 1, 1, true);
+    }
+
+    void AESXTS::decryptSector(uint8_t* data, size_t sectorSize, uint64_t sectorIndex) const
+    {
+        processSectors(data, data, sectorSize, sectorIndex, 1, 1, false);
+    }
+
+    void AESXTS::encryptSectors(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+        uint64_t firstSectorIndex, uint64_t count, size_t numThreads) const
+    {
+        processSectors(src, dest, sectorSize, firstSectorIndex, count, numThreads, true);
+    }
+
+    void AESXTS::decryptSectors(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+        uint64_t firstSectorIndex, uint64_t count, size_t numThreads) const
+    {
+        processSectors(src, dest, sectorSize, firstSectorIndex, count, numThreads, false);
+    }
+
+    void AESXTS::processSector(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+        const block& tweak, bool encrypt) const
+    {
+        size_t fullBlocks = sectorSize / BlockSize;
+        size_t remainder = sectorSize % BlockSize;
+
+        // with ciphertext stealing the last full block is handled
+        // together with the partial one.
+        size_t bulkBlocks = remainder ? fullBlocks - 1 : fullBlocks;
+
+        block t = tweak;
+        size_t j = 0;
+        for (; j + Pipeline <= bulkBlocks; j += Pipeline)
+        {
+            block tw[Pipeline], b[Pipeline];
+            for (size_t i = 0; i < Pipeline; ++i)
+            {
+                tw[i] = t;
+                t = mulAlpha(t);
+                b[i] = xor_blocks(toBlock(src + (j + i) * BlockSize), tw[i]);
+            }
+            crypt_blocks<Pipeline>(mEncKeys, mDecKeys, mRounds, encrypt, b);
+            for (size_t i = 0; i < Pipeline; ++i)
+                store_block(xor_blocks(b[i], tw[i]), dest + (j + i) * BlockSize);
+        }
+
+        for (; j < bulkBlocks; ++j)
+        {
+            block b = xor_blocks(toBlock(src + j * BlockSize), t);
+            crypt_blocks<1>(mEncKeys, mDecKeys, mRounds, encrypt, &b);
+            store_block(xor_blocks(b, t), dest + j * BlockSize);
+            t = mulAlpha(t);
+        }
+
+        if (remainder)
+        {
+            // t is the tweak of the last full block, tNext of the partial one.
+            // Decryption consumes them in the opposite order.
+            block tNext = mulAlpha(t);
+            block first = encrypt ? t : tNext;
+            block second = encrypt ? tNext : t;
+
+            const uint8_t* lastFull = src + bulkBlocks * BlockSize;
+            const uint8_t* partial = lastFull + BlockSize;
+
+            uint8_t stolen[BlockSize], merged[BlockSize];
+            block b = xor_blocks(toBlock(lastFull), first);
+            crypt_blocks<1>(mEncKeys, mDecKeys, mRounds, encrypt, &b);
+            store_block(xor_blocks(b, first), stolen);
+
+            memcpy(merged, partial, remainder);
+            memcpy(merged + remainder, stolen + remainder, BlockSize - remainder);
+            memcpy(dest + (bulkBlocks + 1) * BlockSize, stolen, remainder);
+
+            b = xor_blocks(toBlock(merged), second);
+            crypt_blocks<1>(mEncKeys, mDecKeys, mRounds, encrypt, &b);
+            store_block(xor_blocks(b, second), dest + bulkBlocks * BlockSize);
+        }
+    }
+
+    void AESXTS::processSectors(const uint8_t* src, uint8_t* dest, size_t sectorSize,
+        uint64_t firstSectorIndex, uint64_t count, size_t numThreads, bool encrypt) const
+    {
+        if (sectorSize < BlockSize)
+            throw std::runtime_error("AES-XTS sector size must be at least 16 bytes");
+
+        auto worker = [=, this](uint64_t begin, uint64_t end)
+        {
+            // the initial tweaks of consecutive sectors are independent,
+            // so encrypt them together.
+            for (uint64_t s = begin; s < end; s += Pipeline)
+            {
+                size_t n = std::min<uint64_t>(Pipeline, end - s);
+                block tweaks[Pipeline];
+                for (size_t i = 0; i < Pipeline; ++i)
+                    tweaks[i] = toBlock(0, firstSectorIndex + s + i);
+                encrypt_blocks<Pipeline>(mTweakKeys, mRounds, tweaks);
+
+                for (size_t i = 0; i < n; ++i)
+                    processSector(src + (s + i) * sectorSize, dest + (s + i) * sectorSize,
+                        sectorSize, tweaks[i], encrypt);
+            }
+        };
+
+        if (numThreads == 0)
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        uint64_t maxThreads = std::max<uint64_t>(1, count * sectorSize / MinBytesPerThread);
+        numThreads = std::min<uint64_t>({ numThreads, maxThreads, count });
+
+        if (numThreads <= 1)
+        {
+            worker(0, count);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads - 1);
+        for (size_t i = 1; i < numThreads; ++i)
+            threads.emplace_back(worker, count * i / numThreads, count * (i + 1) / numThreads);
+        worker(0, count / numThreads);
+
+        for (auto& thrd : threads)
+            thrd.join();
+    }
+
+} // namespace simdcrypt
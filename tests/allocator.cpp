@@ -0,0 +1,98 @@
+#include "simdcrypt/BlockAllocator.hpp"
+#include "simdcrypt/PRNG.hpp"
+
+using namespace simdcrypt;
+
+bool aligned(const void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % BlockArena::Alignment == 0;
+}
+
+int main() {
+    for (auto hugePages : { HugePages::None, HugePages::Transparent, HugePages::Explicit }) {
+        BlockArena arena(1 << 16, hugePages);
+
+        // allocations are aligned and do not overlap.
+        uint8_t* a = static_cast<uint8_t*>(arena.allocate(17));
+        uint8_t* b = static_cast<uint8_t*>(arena.allocate(100));
+        if (!aligned(a) || !aligned(b) || (a < b && a + 17 > b)) {
+            printf("Bad allocation\n");
+            return 1;
+        }
+        memset(a, 0xff, 17);
+        memset(b, 0xff, 100);
+
+        // larger than a chunk.
+        uint8_t* big = static_cast<uint8_t*>(arena.allocate(1 << 20));
+        if (!aligned(big)) {
+            printf("Bad large allocation\n");
+            return 1;
+        }
+        memset(big, 0xff, 1 << 20);
+
+        // memory is reused after a reset.
+        size_t capacity = arena.capacity();
+        arena.reset();
+        if (arena.used() != 0 || arena.allocate(17) != a || arena.capacity() != capacity) {
+            printf("Reset does not reuse memory\n");
+            return 1;
+        }
+
+        // the most recent allocation can be given back.
+        void* c = arena.allocate(64);
+        arena.deallocate(c, 64);
+        if (arena.allocate(64) != c) {
+            printf("Deallocate of the last allocation failed\n");
+            return 1;
+        }
+        arena.reset();
+
+        // containers using the arena must be gone before it is released.
+        {
+            // vectors grow inside the arena and are always aligned.
+            BlockVector v(&arena);
+            for (int i = 0; i < 10000; ++i) {
+                v.push_back(toBlock(i));
+                if (!aligned(v.data())) {
+                    printf("Unaligned vector\n");
+                    return 1;
+                }
+            }
+            for (int i = 0; i < 10000; ++i) {
+                if (extract_u64<0>(v[i]) != static_cast<uint64_t>(i)) {
+                    printf("Vector content mismatch\n");
+                    return 1;
+                }
+            }
+
+            // a PRNG using the arena generates the same stream.
+            block seed = toBlock(0x0123456789ABCDEFULL, 0x0FEDCBA987654321ULL);
+            PRNG expected(seed);
+            PRNG prng(seed, 256, &arena);
+            if (!aligned(prng.mBuffer.data())) {
+                printf("Unaligned PRNG buffer\n");
+                return 1;
+            }
+            for (int i = 0; i < 10000; ++i) {
+                if (expected.get<uint64_t>() != prng.get<uint64_t>()) {
+                    printf("PRNG mismatch\n");
+                    return 1;
+                }
+            }
+        }
+
+        arena.release();
+        if (arena.capacity() != 0) {
+            printf("Release failed\n");
+            return 1;
+        }
+    }
+
+    // without an arena the heap is used, still aligned.
+    BlockVector heap(1001);
+    if (!aligned(heap.data())) {
+        printf("Unaligned heap vector\n");
+        return 1;
+    }
+
+    return 0;
+}
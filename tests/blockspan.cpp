@@ -0,0 +1,96 @@
+#include "simdcrypt/BlockSpan.hpp"
+#include "simdcrypt/PRNG.hpp"
+#include <bit>
+#include <vector>
+
+using namespace simdcrypt;
+
+bool same(const block& a, const block& b) {
+    return memcmp(&a, &b, sizeof(block)) == 0;
+}
+
+// checks every bulk operation against a block at a time implementation,
+// for spans starting at an offset of `offset` blocks into the buffers.
+bool check(PRNG& prng, size_t n, size_t offset) {
+    BlockVector a(n + offset), b(n + offset), mask(n + offset), dest(n + offset);
+    std::vector<uint8_t> bits((n + 7) / 8);
+    prng.get(a.data(), a.size());
+    prng.get(b.data(), b.size());
+    prng.get(mask.data(), mask.size());
+    prng.get(bits.data(), bits.size());
+
+    ConstBlockSpan sa(a.data() + offset, n), sb(b.data() + offset, n), sm(mask.data() + offset, n);
+    BlockSpan sd(dest.data() + offset, n);
+
+    xorBlocks(sa, sb, sd);
+    for (size_t i = 0; i < n; ++i) {
+        if (!same(sd[i], xor_blocks(sa[i], sb[i]))) return false;
+    }
+
+    andBlocks(sa, sb, sd);
+    for (size_t i = 0; i < n; ++i) {
+        block expected = toBlock(extract_u64<1>(sa[i]) & extract_u64<1>(sb[i]),
+                                 extract_u64<0>(sa[i]) & extract_u64<0>(sb[i]));
+        if (!same(sd[i], expected)) return false;
+    }
+
+    selectBlocks(sm, sa, sb, sd);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t m1 = extract_u64<1>(sm[i]), m0 = extract_u64<0>(sm[i]);
+        block expected = toBlock((extract_u64<1>(sa[i]) & ~m1) | (extract_u64<1>(sb[i]) & m1),
+                                 (extract_u64<0>(sa[i]) & ~m0) | (extract_u64<0>(sb[i]) & m0));
+        if (!same(sd[i], expected)) return false;
+    }
+
+    andBits(bits.data(), sa, sd);
+    for (size_t i = 0; i < n; ++i) {
+        bool bit = (bits[i / 8] >> (i % 8)) & 1;
+        if (!same(sd[i], bit ? sa[i] : ZeroBlock)) return false;
+    }
+
+    uint64_t weight = 0;
+    for (size_t i = 0; i < n; ++i) {
+        weight += std::popcount(extract_u64<0>(sa[i])) + std::popcount(extract_u64<1>(sa[i]));
+    }
+    if (hammingWeight(sa) != weight) return false;
+
+    // in place operation on an exact alias
+    BlockVector copy(a);
+    xorBlocks(sa, sb, BlockSpan(copy.data() + offset, n));
+    xorBlocks(ConstBlockSpan(copy.data() + offset, n), sb, BlockSpan(copy.data() + offset, n));
+    if (!equalBlocks(ConstBlockSpan(copy.data() + offset, n), sa)) return false;
+
+    if (n) {
+        copy[offset + n - 1] = xor_blocks(copy[offset + n - 1], toBlock(1));
+        if (equalBlocks(ConstBlockSpan(copy.data() + offset, n), sa)) return false;
+    }
+
+    return true;
+}
+
+int main() {
+    PRNG prng(toBlock(0x0123456789ABCDEFULL, 0x0FEDCBA987654321ULL));
+
+    for (auto level : { SimdLevel::Baseline, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (setSimdLevel(level) != level) {
+            continue;
+        }
+
+        for (size_t n : { 0, 1, 2, 3, 4, 5, 7, 8, 9, 63, 64, 65, 1000 }) {
+            for (size_t offset : { 0, 1, 2, 3 }) {
+                if (!check(prng, n, offset)) {
+                    printf("Mismatch at level %d, size %zu, offset %zu\n", static_cast<int>(level), n, offset);
+                    return 1;
+                }
+            }
+        }
+
+        // large enough for non-temporal stores.
+        if (!check(prng, (1 << 20) + 3, 1)) {
+            printf("Mismatch at level %d for a large input\n", static_cast<int>(level));
+            return 1;
+        }
+    }
+
+    return 0;
+}
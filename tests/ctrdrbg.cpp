@@ -0,0 +1,357 @@
+#include "simdcrypt/CtrDrbg.hpp"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace simdcrypt;
+
+typedef std::vector<uint8_t> Request;
+
+const uint8_t entropy[CtrDrbg::SeedLength] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+};
+
+// entropy source returning a counter in every byte, counting its calls.
+CtrDrbg::EntropySource countingSource(size_t& calls) {
+    return [&calls](uint8_t* dest, size_t length) {
+        ++calls;
+        memset(dest, static_cast<int>(calls), length);
+        return true;
+    };
+}
+
+std::vector<Request> getRequests(CtrDrbg& drbg, size_t count) {
+    std::vector<Request> requests(count, Request(CtrDrbg::RequestBytes));
+    for (auto& r : requests) {
+        drbg.get(r.data(), r.size());
+    }
+    return requests;
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+// gets length bytes from drbg in a forked child, returned through a pipe.
+// Returns false if the child failed, e.g. because get threw.
+bool getInChild(CtrDrbg& drbg, std::vector<uint8_t>& out) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        int status = 0;
+        try {
+            drbg.get(out.data(), out.size());
+            if (write(fds[1], out.data(), out.size()) != static_cast<ssize_t>(out.size())) {
+                status = 1;
+            }
+        } catch (const std::runtime_error&) {
+            status = 2;
+        }
+        _exit(status);
+    }
+    close(fds[1]);
+
+    size_t read = 0;
+    while (pid > 0 && read < out.size()) {
+        ssize_t n = ::read(fds[0], out.data() + read, out.size() - read);
+        if (n <= 0) {
+            break;
+        }
+        read += static_cast<size_t>(n);
+    }
+    close(fds[0]);
+
+    int status = -1;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 && read == out.size();
+}
+#endif
+
+int main() {
+    // identical instances give identical output, whatever the split of
+    // the get calls.
+    {
+        CtrDrbg a(entropy, nullptr, 0, nullptr, false, CtrDrbg::MaxReseedInterval, 3);
+        CtrDrbg b(entropy, nullptr, 0, nullptr, false, CtrDrbg::MaxReseedInterval, 3);
+        std::vector<uint8_t> x(10 * CtrDrbg::RequestBytes + 123), y(x.size());
+        a.get(x.data(), x.size());
+        for (size_t i = 0; i < y.size(); i += 7) {
+            b.get(y.data() + i, std::min<size_t>(7, y.size() - i));
+        }
+        if (x != y) {
+            printf("Output depends on the size of the get calls\n");
+            return 1;
+        }
+
+        // the personalization string changes the output.
+        uint8_t personalization[] = { 1, 2, 3 };
+        CtrDrbg c(entropy, personalization, sizeof(personalization));
+        std::vector<uint8_t> z(x.size());
+        c.get(z.data(), z.size());
+        if (x == z) {
+            printf("Personalization string ignored\n");
+            return 1;
+        }
+    }
+
+    // an epoch is capped to the largest generate request of SP 800-90A.
+    {
+        CtrDrbg a(entropy, nullptr, 0, nullptr, false, CtrDrbg::MaxReseedInterval, 1024);
+        CtrDrbg b(entropy, nullptr, 0, nullptr, false, CtrDrbg::MaxReseedInterval, CtrDrbg::MaxEpochRequests);
+        if (getRequests(a, 3 * CtrDrbg::MaxEpochRequests) != getRequests(b, 3 * CtrDrbg::MaxEpochRequests)) {
+            printf("Epoch not capped to MaxEpochRequests\n");
+            return 1;
+        }
+    }
+
+    // requests served to concurrent threads are distinct requests of the
+    // single threaded stream.
+    {
+        const size_t numThreads = 8, perThread = 64;
+        CtrDrbg shared(entropy, nullptr, 0, nullptr, false, CtrDrbg::MaxReseedInterval, 4);
+        std::vector<std::vector<Request>> results(numThreads);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t]() { results[t] = getRequests(shared, perThread); });
+        }
+        for (auto& thrd : threads) {
+            thrd.join();
+        }
+
+        CtrDrbg reference(entropy, nullptr, 0, nullptr, false, CtrDrbg::MaxReseedInterval, 4);
+        auto expected = getRequests(reference, 2 * numThreads * perThread);
+        std::set<Request> expectedSet(expected.begin(), expected.end()), seen;
+        for (auto& result : results) {
+            for (auto& r : result) {
+                if (!expectedSet.count(r) || !seen.insert(r).second) {
+                    printf("Concurrent output is not a distinct part of the stream\n");
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // explicit reseeds racing with concurrent requests keep the output
+    // distinct.
+    {
+        const size_t numThreads = 4, perThread = 256;
+        size_t calls = 0;
+        CtrDrbg shared(entropy, nullptr, 0, countingSource(calls), false, CtrDrbg::MaxReseedInterval, 2);
+        std::vector<std::vector<Request>> results(numThreads);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t]() { results[t] = getRequests(shared, perThread); });
+        }
+        for (int i = 0; i < 100; ++i) {
+            shared.reseed();
+            std::this_thread::yield();
+        }
+        for (auto& thrd : threads) {
+            thrd.join();
+        }
+
+        std::set<Request> seen;
+        for (auto& result : results) {
+            for (auto& r : result) {
+                if (!seen.insert(r).second) {
+                    printf("Repeated output with concurrent reseeds\n");
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // reseeds once reseedInterval requests have been made. With two
+    // requests per epoch the third epoch is reseeded. The reseed is made
+    // ahead of need, when the epoch before starts.
+    {
+        size_t calls = 0;
+        CtrDrbg drbg(entropy, nullptr, 0, countingSource(calls), false, 4, 2);
+        CtrDrbg noReseed(entropy, nullptr, 0, nullptr, false, CtrDrbg::MaxReseedInterval, 2);
+        auto a = getRequests(drbg, 4);
+        auto b = getRequests(noReseed, 4);
+        if (calls != 1 || a != b) {
+            printf("Reseeded too early\n");
+            return 1;
+        }
+        a = getRequests(drbg, 8);
+        b = getRequests(noReseed, 8);
+        if (calls != 3 || a[0] == b[0]) {
+            printf("Expected 3 reseeds, got %zu\n", calls);
+            return 1;
+        }
+
+        // the requests after an explicit reseed come from the new state.
+        size_t sameCalls = 0;
+        CtrDrbg same(entropy, nullptr, 0, countingSource(sameCalls), false, 4, 2);
+        getRequests(same, 12);
+        drbg.reseed(entropy, sizeof(entropy));
+        if (calls != 4 || getRequests(drbg, 1) == getRequests(same, 1)) {
+            printf("Explicit reseed did not take effect\n");
+            return 1;
+        }
+
+        // including for the rest of the request this thread had buffered.
+        size_t pCalls = 0, qCalls = 0;
+        CtrDrbg p(entropy, nullptr, 0, countingSource(pCalls));
+        CtrDrbg q(entropy, nullptr, 0, countingSource(qCalls));
+        std::vector<uint8_t> x(CtrDrbg::RequestBytes), y(x.size());
+        p.get(x.data(), 1);
+        p.reseed();
+        p.get(x.data() + 1, x.size() - 1);
+        q.get(y.data(), 1);
+        q.get(y.data() + 1, y.size() - 1);
+        if (x[0] != y[0] || memcmp(x.data() + 1, y.data() + 1, 16) == 0) {
+            printf("Buffered output served after an explicit reseed\n");
+            return 1;
+        }
+    }
+
+    // without an entropy source, get throws once a reseed is required.
+    {
+        CtrDrbg drbg(entropy, nullptr, 0, nullptr, false, 2, 1);
+        bool thrown = false;
+        try {
+            getRequests(drbg, 3);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        if (!thrown) {
+            printf("Missing reseed not detected\n");
+            return 1;
+        }
+
+        thrown = false;
+        try {
+            CtrDrbg pr(entropy, nullptr, 0, nullptr, true);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        if (!thrown) {
+            printf("Prediction resistance without an entropy source accepted\n");
+            return 1;
+        }
+    }
+
+    // prediction resistance reseeds at every get, the first one included,
+    // and once per MaxGenerateBytes.
+    {
+        size_t calls = 0;
+        CtrDrbg drbg(entropy, nullptr, 0, countingSource(calls), true);
+        if (calls != 0) {
+            printf("Prediction resistance reseeded before the first request\n");
+            return 1;
+        }
+        getRequests(drbg, 5);
+        drbg.get<uint8_t>();
+        drbg.get<uint8_t>();
+        std::vector<uint8_t> large(CtrDrbg::MaxGenerateBytes + 1);
+        drbg.get(large.data(), large.size());
+        if (calls != 9) {
+            printf("Expected 9 reseeds with prediction resistance, got %zu\n", calls);
+            return 1;
+        }
+
+        CtrDrbg pr(entropy, nullptr, 0, [](uint8_t*, size_t) { return false; }, true);
+        bool thrown = false;
+        try {
+            pr.get<uint64_t>();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        if (!thrown) {
+            printf("Entropy source failure not detected\n");
+            return 1;
+        }
+    }
+
+    // the global instance is usable from any thread.
+    {
+        std::vector<uint64_t> values(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < values.size(); ++t) {
+            threads.emplace_back([&, t]() { values[t] = CtrDrbg::global().get<uint64_t>(); });
+        }
+        for (auto& thrd : threads) {
+            thrd.join();
+        }
+        std::sort(values.begin(), values.end());
+        if (std::adjacent_find(values.begin(), values.end()) != values.end()) {
+            printf("Global instance repeated a value\n");
+            return 1;
+        }
+    }
+
+#if defined(__linux__) || defined(__APPLE__)
+    // parent and child of a fork do not share output, even with a copied
+    // entropy source and bytes left in the thread local buffer. The parent
+    // is unaffected by the fork.
+    for (bool predictionResistance : { false, true }) {
+        size_t calls = 0, sameCalls = 0;
+        CtrDrbg drbg(entropy, nullptr, 0, countingSource(calls), predictionResistance, 4, 2);
+        CtrDrbg same(entropy, nullptr, 0, countingSource(sameCalls), predictionResistance, 4, 2);
+        std::vector<uint8_t> child(3 * CtrDrbg::RequestBytes), parent(child.size()), expected(child.size());
+        // the thread local buffer is shared, use one instance at a time.
+        same.get<uint8_t>();
+        same.get(expected.data(), expected.size());
+
+        drbg.get<uint8_t>();
+        if (!getInChild(drbg, child)) {
+            printf("Child of a fork failed to generate\n");
+            return 1;
+        }
+        drbg.get(parent.data(), parent.size());
+        if (parent != expected) {
+            printf("Fork changed the output of the parent\n");
+            return 1;
+        }
+        for (size_t i = 0; i + 16 <= child.size(); i += 16) {
+            if (std::search(parent.begin(), parent.end(), child.begin() + i, child.begin() + i + 16) != parent.end()) {
+                printf("Parent and child of a fork repeated output, prediction resistance %d\n", predictionResistance);
+                return 1;
+            }
+        }
+    }
+
+    // without an entropy source the child cannot reseed and must not
+    // generate.
+    {
+        CtrDrbg drbg(entropy);
+        drbg.get<uint8_t>();
+        std::vector<uint8_t> child(16);
+        if (getInChild(drbg, child)) {
+            printf("Child of a fork generated without an entropy source\n");
+            return 1;
+        }
+        drbg.get<uint64_t>();
+    }
+
+    // same for the global instance.
+    {
+        CtrDrbg::global().get<uint8_t>();
+        std::vector<uint8_t> child(64), parent(child.size());
+        if (!getInChild(CtrDrbg::global(), child)) {
+            printf("Child of a fork failed to use the global instance\n");
+            return 1;
+        }
+        CtrDrbg::global().get(parent.data(), parent.size());
+        if (parent == child) {
+            printf("Global instance repeated its output across fork\n");
+            return 1;
+        }
+    }
+#endif
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "simdcrypt/AESHash.hpp"
+#include "simdcrypt/PRNG.hpp"
 
 int main()
 {
@@ -20,5 +21,31 @@ int main()
         }
     }
 
+    // hashMany must agree with AESHash for every length, including empty
+    // messages and ones that are not a multiple of the block size.
+    simdcrypt::PRNG prng(simdcrypt::toBlock(42));
+    const size_t n = 1000;
+    std::vector<std::vector<uint8_t>> messages(n);
+    std::vector<const uint8_t*> msgs(n);
+    std::vector<size_t> lens(n);
+    for (size_t i = 0; i < n; ++i) {
+        messages[i].resize(prng.get<uint32_t>() % 300);
+        prng.get(messages[i].data(), messages[i].size());
+        msgs[i] = messages[i].data();
+        lens[i] = messages[i].size();
+    }
+
+    std::vector<uint8_t> digests(n * simdcrypt::AESHash::HashSize);
+    simdcrypt::AESHash::hashMany(msgs.data(), lens.data(), n, digests.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        hasher.Update(msgs[i], lens[i]);
+        hasher.Final(hash);
+        if (memcmp(hash, digests.data() + i * simdcrypt::AESHash::HashSize, simdcrypt::AESHash::HashSize) != 0) {
+            printf("hashMany mismatch for message %zu of length %zu\n", i, lens[i]);
+            return 1;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
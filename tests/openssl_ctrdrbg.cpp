@@ -0,0 +1,135 @@
+#include "simdcrypt/CtrDrbg.hpp"
+#include "openssl/core_names.h"
+#include "openssl/evp.h"
+#include "openssl/params.h"
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+using namespace simdcrypt;
+
+void random_bytes(std::vector<uint8_t>& bytes) {
+    for (auto& b : bytes) {
+        b = rand() % 256;
+    }
+}
+
+// OpenSSL's CTR-DRBG with AES-128 and no derivation function, fed by a
+// TEST-RAND parent that hands out the given entropy for every request.
+// ok is false if any step of the setup failed.
+struct OpensslDrbg {
+    EVP_RAND_CTX* parent = nullptr;
+    EVP_RAND_CTX* drbg = nullptr;
+    bool ok = false;
+
+    OpensslDrbg(std::vector<uint8_t>& entropy, const std::vector<uint8_t>& personalization,
+                uint64_t generateInterval) {
+        EVP_RAND* testRand = EVP_RAND_fetch(nullptr, "TEST-RAND", nullptr);
+        EVP_RAND* ctrDrbg = EVP_RAND_fetch(nullptr, "CTR-DRBG", nullptr);
+        if (testRand && ctrDrbg) {
+            parent = EVP_RAND_CTX_new(testRand, nullptr);
+            if (parent) {
+                drbg = EVP_RAND_CTX_new(ctrDrbg, parent);
+            }
+        }
+        EVP_RAND_free(testRand);
+        EVP_RAND_free(ctrDrbg);
+        if (!drbg) {
+            return;
+        }
+
+        unsigned int strength = 256;
+        OSSL_PARAM parentParams[] = {
+            OSSL_PARAM_construct_uint(OSSL_RAND_PARAM_STRENGTH, &strength),
+            OSSL_PARAM_construct_octet_string(OSSL_RAND_PARAM_TEST_ENTROPY, entropy.data(), entropy.size()),
+            OSSL_PARAM_construct_end(),
+        };
+        if (EVP_RAND_CTX_set_params(parent, parentParams) != 1 ||
+            EVP_RAND_instantiate(parent, strength, 0, nullptr, 0, nullptr) != 1) {
+            return;
+        }
+
+        // OpenSSL reseeds after requests - 1 generate calls, or never if
+        // 0, and also after some time unless disabled.
+        char cipher[] = "AES-128-CTR";
+        int useDf = 0;
+        unsigned int requests = generateInterval < UINT_MAX ? static_cast<unsigned int>(generateInterval + 1) : 0;
+        time_t seconds = 0;
+        OSSL_PARAM params[] = {
+            OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_CIPHER, cipher, 0),
+            OSSL_PARAM_construct_int(OSSL_DRBG_PARAM_USE_DF, &useDf),
+            OSSL_PARAM_construct_uint(OSSL_DRBG_PARAM_RESEED_REQUESTS, &requests),
+            OSSL_PARAM_construct_time_t(OSSL_DRBG_PARAM_RESEED_TIME_INTERVAL, &seconds),
+            OSSL_PARAM_construct_end(),
+        };
+        ok = EVP_RAND_CTX_set_params(drbg, params) == 1 &&
+             EVP_RAND_instantiate(drbg, 128, 0, personalization.data(), personalization.size(), nullptr) == 1;
+    }
+
+    ~OpensslDrbg() {
+        EVP_RAND_CTX_free(drbg);
+        EVP_RAND_CTX_free(parent);
+    }
+
+    bool generate(uint8_t* dest, size_t length, bool predictionResistance) {
+        return EVP_RAND_generate(drbg, dest, length, 128, predictionResistance, nullptr, 0) == 1;
+    }
+};
+
+// Compares count epochs of epochRequests requests with OpenSSL generate
+// calls of one epoch each, or count gets of length bytes if given.
+bool compare(bool predictionResistance, uint64_t reseedInterval, uint64_t epochRequests, size_t count,
+             size_t length = 0) {
+    std::vector<uint8_t> entropy(CtrDrbg::SeedLength);
+    random_bytes(entropy);
+    std::vector<uint8_t> personalization(rand() % (CtrDrbg::SeedLength + 1));
+    random_bytes(personalization);
+
+    OpensslDrbg openssl(entropy, personalization, reseedInterval / epochRequests);
+    if (!openssl.ok) {
+        printf("OpenSSL CTR-DRBG setup failed\n");
+        return false;
+    }
+
+    CtrDrbg drbg(entropy.data(), personalization.data(), personalization.size(),
+        [&](uint8_t* dest, size_t length) {
+            memcpy(dest, entropy.data(), std::min(length, entropy.size()));
+            return length <= entropy.size();
+        },
+        predictionResistance, reseedInterval, epochRequests);
+
+    std::vector<uint8_t> expected(length ? length : epochRequests * CtrDrbg::RequestBytes), actual(expected.size());
+    for (size_t i = 0; i < count; ++i) {
+        if (!openssl.generate(expected.data(), expected.size(), predictionResistance)) {
+            printf("OpenSSL generate failed\n");
+            return false;
+        }
+        drbg.get(actual.data(), actual.size());
+        if (actual != expected) {
+            printf("Mismatch with OpenSSL (prediction resistance %d, reseed interval %llu, epoch %llu) at %zu\n",
+                predictionResistance, (unsigned long long)reseedInterval, (unsigned long long)epochRequests, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    // with one request per epoch the output is that of CTR_DRBG, and an
+    // epoch of several requests is a single CTR_DRBG generate.
+    for (uint64_t epochRequests : { uint64_t(1), uint64_t(8), CtrDrbg::MaxEpochRequests }) {
+        if (!compare(false, CtrDrbg::MaxReseedInterval, epochRequests, 10) ||
+            !compare(false, 3 * epochRequests, epochRequests, 20)) {
+            return 1;
+        }
+    }
+
+    // with prediction resistance every get is one CTR_DRBG generate,
+    // whatever its length.
+    for (size_t length : { size_t(1000), CtrDrbg::RequestBytes, CtrDrbg::MaxGenerateBytes }) {
+        if (!compare(true, CtrDrbg::MaxReseedInterval, 1, 10, length)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "simdcrypt/XTS.hpp"
+#include "openssl/evp.h"
+#include <vector>
+
+using namespace simdcrypt;
+
+void random_bytes(std::vector<uint8_t>& bytes) {
+    for (auto& b : bytes) {
+        b = rand() % 256;
+    }
+}
+
+// Encrypts a single sector with OpenSSL's AES-XTS.
+bool openssl_xts(const std::vector<uint8_t>& key, uint64_t sector,
+                 const uint8_t* in, uint8_t* out, size_t length) {
+    const EVP_CIPHER* cipher = key.size() == 32 ? EVP_aes_128_xts() : EVP_aes_256_xts();
+
+    uint8_t iv[16] = {0};
+    for (int i = 0; i < 8; ++i) {
+        iv[i] = static_cast<uint8_t>(sector >> (8 * i));
+    }
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    int outLength = 0;
+    bool ok = EVP_EncryptInit_ex(ctx, cipher, nullptr, key.data(), iv) == 1 &&
+              EVP_EncryptUpdate(ctx, out, &outLength, in, static_cast<int>(length)) == 1 &&
+              static_cast<size_t>(outLength) == length;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
+int main() {
+    for (size_t keyLength : { 32, 64 }) {
+        for (size_t sectorSize : { 16, 31, 32, 100, 512, 4096, 4097 }) {
+            std::vector<uint8_t> key(keyLength);
+            random_bytes(key);
+            // OpenSSL rejects XTS keys whose two halves are equal.
+            key[0] = ~key[keyLength / 2];
+
+            const uint64_t count = 16, first = rand();
+            std::vector<uint8_t> plaintext(count * sectorSize);
+            random_bytes(plaintext);
+
+            std::vector<uint8_t> expected(plaintext.size());
+            for (uint64_t s = 0; s < count; ++s) {
+                if (!openssl_xts(key, first + s, plaintext.data() + s * sectorSize,
+                                 expected.data() + s * sectorSize, sectorSize)) {
+                    return 1;
+                }
+            }
+
+            AESXTS xts(key.data(), key.size());
+            std::vector<uint8_t> ciphertext(plaintext.size());
+            xts.encryptSectors(plaintext.data(), ciphertext.data(), sectorSize, first, count);
+
+            if (ciphertext != expected) {
+                printf("Mismatch with OpenSSL (key %zu, sector %zu)\n", keyLength, sectorSize);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "simdcrypt/PRNG.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace simdcrypt;
+
+// 10 MB + 3, neither a multiple of the tool's chunks nor of a block.
+const size_t length = (10 << 20) + 3;
+
+std::vector<uint8_t> readAll(FILE* f) {
+    std::vector<uint8_t> data(length + 1);
+    size_t n = fread(data.data(), 1, data.size(), f);
+    data.resize(n);
+    return data;
+}
+
+// runs `simdcrypt-rng <args>` and returns its output, through a file or
+// through a pipe.
+bool run(const std::string& tool, const std::string& args, bool pipe, std::vector<uint8_t>& output) {
+    std::string command = tool + " " + args + " -n " + std::to_string(length);
+    if (pipe) {
+        FILE* f = popen(command.c_str(), "r");
+        if (!f) {
+            return false;
+        }
+        output = readAll(f);
+        return pclose(f) == 0;
+    }
+
+    const char* path = "rng-tool-test.bin";
+    if (system((command + " -o " + path).c_str()) != 0) {
+        return false;
+    }
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    output = readAll(f);
+    fclose(f);
+    remove(path);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        printf("usage: rng-tool-test <path to simdcrypt-rng>\n");
+        return 1;
+    }
+
+    // the tool's output is the stream of PRNG(seed).
+    PRNG prng(toBlock(0, 0x0123456789abcdefULL));
+    std::vector<uint8_t> expected(length);
+    prng.get(expected.data(), expected.size());
+
+    struct Case {
+        const char* args;
+        bool pipe;
+    };
+    const Case cases[] = {
+        { "0123456789abcdef -t 3", false },
+        { "0x0123456789abcdef -t 3", true },
+        { "0123456789abcdef -t 3 --no-splice", true },
+    };
+
+    for (auto& c : cases) {
+        std::vector<uint8_t> output;
+        if (!run(argv[1], c.args, c.pipe, output)) {
+            printf("simdcrypt-rng %s failed\n", c.args);
+            return 1;
+        }
+        if (output != expected) {
+            printf("simdcrypt-rng %s (%s): output differs from PRNG\n", c.args, c.pipe ? "pipe" : "file");
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "simdcrypt/XTS.hpp"
+#include <string>
+#include <vector>
+
+using namespace simdcrypt;
+
+std::vector<uint8_t> fromHex(const std::string& hex) {
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+struct TestVector {
+    const char* key1;
+    const char* key2;
+    uint64_t sector;
+    const char* plaintext;
+    const char* ciphertext;
+};
+
+// test vectors from IEEE 1619-2007, Annex B.
+const TestVector vectors[] = {
+    // Vector 1
+    {
+        "00000000000000000000000000000000",
+        "00000000000000000000000000000000",
+        0,
+        "0000000000000000000000000000000000000000000000000000000000000000",
+        "917cf69ebd68b2ec9b9fe9a3eadda692cd43d2f59598ed858c02c2652fbf922e"
+    },
+    // Vector 2
+    {
+        "11111111111111111111111111111111",
+        "22222222222222222222222222222222",
+        0x3333333333,
+        "4444444444444444444444444444444444444444444444444444444444444444",
+        "c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0"
+    },
+    // Vector 3
+    {
+        "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0",
+        "22222222222222222222222222222222",
+        0x3333333333,
+        "4444444444444444444444444444444444444444444444444444444444444444",
+        "af85336b597afc1a900b2eb21ec949d292df4c047e0b21532186a5971a227a89"
+    },
+    // Vector 10
+    {
+        "2718281828459045235360287471352662497757247093699959574966967627",
+        "3141592653589793238462643383279502884197169399375105820974944592",
+        0xff,
+        "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+        "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+        "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9fa0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+        "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"
+        "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+        "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+        "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9fa0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+        "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+        "1c3b3a102f770386e4836c99e370cf9bea00803f5e482357a4ae12d414a3e63b5d31e276f8fe4a8d66b317f9ac683f44680a86ac35adfc3345befecb4bb188fd"
+        "5776926c49a3095eb108fd1098baec70aaa66999a72a82f27d848b21d4a741b0c5cd4d5fff9dac89aeba122961d03a757123e9870f8acf1000020887891429ca"
+        "2a3e7a7d7df7b10355165c8b9a6d0a7de8b062c4500dc4cd120c0f7418dae3d0b5781c34803fa75421c790dfe1de1834f280d7667b327f6c8cd7557e12ac3a0f"
+        "93ec05c52e0493ef31a12d3d9260f79a289d6a379bc70c50841473d1a8cc81ec583e9645e07b8d9670655ba5bbcfecc6dc3966380ad8fecb17b6ba02469a020a"
+        "84e18e8f84252070c13e9f1f289be54fbc481457778f616015e1327a02b140f1505eb309326d68378f8374595c849d84f4c333ec4423885143cb47bd71c5edae"
+        "9be69a2ffeceb1bec9de244fbe15992b11b77c040f12bd8f6a975a44a0f90c29a9abc3d4d893927284c58754cce294529f8614dcd2aba991925fedc4ae74ffac"
+        "6e333b93eb4aff0479da9a410e4450e0dd7ae4c6e2910900575da401fc07059f645e8b7e9bfdef33943054ff84011493c27b3429eaedb4ed5376441a77ed4385"
+        "1ad77f16f541dfd269d50d6a5f14fb0aab1cbb4c1550be97f7ab4066193c4caa773dad38014bd2092fa755c824bb5e54c4f36ffda9fcea70b9c6e693e148c151"
+    },
+    // Vector 15
+    {
+        "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0",
+        "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+        0x123456789a,
+        "000102030405060708090a0b0c0d0e0f10",
+        "6c1625db4671522d3d7599601de7ca09ed"
+    },
+    // Vector 16
+    {
+        "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0",
+        "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+        0x123456789a,
+        "000102030405060708090a0b0c0d0e0f1011",
+        "d069444b7a7e0cab09e24447d24deb1fedbf"
+    },
+    // Vector 17
+    {
+        "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0",
+        "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+        0x123456789a,
+        "000102030405060708090a0b0c0d0e0f101112",
+        "e5df1351c0544ba1350b3363cd8ef4beedbf9d"
+    },
+    // Vector 18
+    {
+        "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0",
+        "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+        0x123456789a,
+        "000102030405060708090a0b0c0d0e0f10111213",
+        "9d84c813f719aa2c7be3f66171c7c5c2edbf9dac"
+    },
+};
+
+int main() {
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); ++v) {
+        auto key = fromHex(std::string(vectors[v].key1) + vectors[v].key2);
+        auto plaintext = fromHex(vectors[v].plaintext);
+        auto ciphertext = fromHex(vectors[v].ciphertext);
+
+        AESXTS xts(key.data(), key.size());
+
+        auto data = plaintext;
+        xts.encryptSector(data.data(), data.size(), vectors[v].sector);
+        if (data != ciphertext) {
+            printf("Vector %zu: ciphertext mismatch\n", v);
+            return 1;
+        }
+
+        xts.decryptSector(data.data(), data.size(), vectors[v].sector);
+        if (data != plaintext) {
+            printf("Vector %zu: plaintext mismatch\n", v);
+            return 1;
+        }
+    }
+
+    // bulk processing of many sectors must agree with sector at a time
+    // processing, for both the AES-128 and AES-256 variants.
+    for (size_t keyLength : { 32, 64 }) {
+        for (size_t sectorSize : { 16, 17, 512, 4096, 4100 }) {
+            std::vector<uint8_t> key(keyLength);
+            for (size_t i = 0; i < keyLength; ++i) key[i] = static_cast<uint8_t>(i * 7 + 1);
+            AESXTS xts(key.data(), key.size());
+
+            const uint64_t count = 37, first = 0xfffffffffffffff0ull;
+            std::vector<uint8_t> plaintext(count * sectorSize);
+            for (size_t i = 0; i < plaintext.size(); ++i) plaintext[i] = static_cast<uint8_t>(i * 13);
+
+            std::vector<uint8_t> expected = plaintext;
+            for (uint64_t s = 0; s < count; ++s) {
+                xts.encryptSector(expected.data() + s * sectorSize, sectorSize, first + s);
+            }
+
+            for (size_t threads : { 1, 4 }) {
+                std::vector<uint8_t> data(plaintext.size());
+                xts.encryptSectors(plaintext.data(), data.data(), sectorSize, first, count, threads);
+                if (data != expected) {
+                    printf("Bulk encryption mismatch (key %zu, sector %zu)\n", keyLength, sectorSize);
+                    return 1;
+                }
+                xts.decryptSectors(data.data(), sectorSize, first, count, threads);
+                if (data != plaintext) {
+                    printf("Bulk decryption mismatch (key %zu, sector %zu)\n", keyLength, sectorSize);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
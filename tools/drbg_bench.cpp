@@ -0,0 +1,94 @@
+// simdcrypt-drbg-bench: throughput of the shared CtrDrbg against a PRNG
+// behind a mutex, the usual way of sharing a PRNG between threads.
+#include "simdcrypt/CtrDrbg.hpp"
+#include "simdcrypt/PRNG.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace simdcrypt;
+
+namespace {
+
+    // every thread draws bytes in requests of this size.
+    constexpr size_t GetBytes = 64;
+
+    // returns the total throughput in MB/s of numThreads threads calling
+    // get(dest, GetBytes) for the given duration.
+    template <typename Get>
+    double measure(size_t numThreads, double seconds, Get get)
+    {
+        std::atomic<bool> stop{ false };
+        std::vector<uint64_t> bytes(numThreads);
+        std::vector<std::thread> threads;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                uint8_t dest[GetBytes];
+                uint64_t n = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    for (int i = 0; i < 64; ++i)
+                        get(dest, GetBytes);
+                    n += 64 * GetBytes;
+                }
+                bytes[t] = n;
+            });
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (auto& thrd : threads)
+            thrd.join();
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t total = 0;
+        for (auto n : bytes)
+            total += n;
+        return total / elapsed / 1e6;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double seconds = 1.0;
+    if (argc > 1)
+        maxThreads = std::max(1, std::atoi(argv[1]));
+    if (argc > 2)
+        seconds = std::max(0.01, std::atof(argv[2]));
+
+    uint8_t entropy[CtrDrbg::SeedLength] = {};
+    block seed = toBlock(0x0123456789ABCDEFULL, 0x0FEDCBA987654321ULL);
+
+    printf("threads  CtrDrbg MB/s  PRNG+mutex MB/s\n");
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        CtrDrbg drbg(entropy);
+        double drbgRate = measure(numThreads, seconds,
+            [&](uint8_t* dest, size_t length) { drbg.get(dest, length); });
+
+        PRNG prng(seed);
+        std::mutex mutex;
+        double prngRate = measure(numThreads, seconds,
+            [&](uint8_t* dest, size_t length)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                prng.get(dest, length);
+            });
+
+        printf("%7zu  %12.1f  %15.1f\n", numThreads, drbgRate, prngRate);
+        if (numThreads < maxThreads && numThreads * 2 > maxThreads)
+            numThreads = maxThreads / 2;
+    }
+    return 0;
+}
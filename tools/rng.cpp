@@ -0,0 +1,332 @@
+// simdcrypt-rng: writes the stream of PRNG(seed) to stdout or a file.
+//
+// The output is split into chunks of ChunkBytes which worker threads fill
+// independently through AES::ecbEncCounterMode, as the stream is just the
+// encryption of consecutive counters. The main thread writes the chunks
+// out in order, with vmsplice(2) when stdout is a pipe on Linux.
+#include "simdcrypt/AES.hpp"
+#include "simdcrypt/BlockAllocator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+  #include <sys/uio.h>
+#endif
+
+using namespace simdcrypt;
+
+namespace {
+
+    constexpr uint64_t ChunkBytes = 4 << 20;
+    constexpr uint64_t ChunkBlocks = ChunkBytes / sizeof(block);
+    constexpr uint64_t Unlimited = std::numeric_limits<uint64_t>::max();
+    // each thread comes with a chunk buffer.
+    constexpr uint64_t MaxThreads = 1024;
+
+    void usage()
+    {
+        fprintf(stderr,
+            "usage: simdcrypt-rng <seed> [-n bytes] [-t threads] [-o file] [--no-splice]\n"
+            "\n"
+            "Writes the output of PRNG(seed) to stdout or a file.\n"
+            "\n"
+            "  seed         up to 32 hex digits, the 128 bit seed toBlock(high, low)\n"
+            "  -n bytes     number of bytes to write, with an optional k, m or g\n"
+            "               suffix (default: until the reader exits)\n"
+            "  -t threads   number of generating threads, at most 1024 (default:\n"
+            "               all cores)\n"
+            "  -o file      write to file instead of stdout\n"
+            "  --no-splice  use write(2) even if stdout is a pipe\n");
+    }
+
+    bool parseSeed(std::string s, block& seed)
+    {
+        if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+            s = s.substr(2);
+        if (s.empty() || s.size() > 32 || s.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+            return false;
+
+        size_t split = s.size() > 16 ? s.size() - 16 : 0;
+        uint64_t high = split ? std::stoull(s.substr(0, split), nullptr, 16) : 0;
+        uint64_t low = std::stoull(s.substr(split), nullptr, 16);
+        seed = toBlock(high, low);
+        return true;
+    }
+
+    // parses an unsigned decimal number taking all of s. std::stoull
+    // alone accepts leading white space, signs and trailing garbage.
+    bool parseUnsigned(const std::string& s, uint64_t& value, size_t& end)
+    {
+        if (s.empty() || s[0] < '0' || s[0] > '9')
+            return false;
+        try
+        {
+            value = std::stoull(s, &end, 10);
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool parseBytes(const std::string& s, uint64_t& bytes)
+    {
+        size_t end = 0;
+        if (!parseUnsigned(s, bytes, end))
+            return false;
+
+        if (end + 1 == s.size())
+        {
+            int shift;
+            switch (s[end])
+            {
+            case 'k': case 'K': shift = 10; break;
+            case 'm': case 'M': shift = 20; break;
+            case 'g': case 'G': shift = 30; break;
+            default: return false;
+            }
+            if (bytes > (Unlimited >> shift))
+                return false;
+            bytes <<= shift;
+        }
+        else if (end != s.size())
+            return false;
+
+        // Unlimited is reserved for the default of writing forever.
+        return bytes != Unlimited;
+    }
+
+    bool parseThreads(const std::string& s, size_t& threads)
+    {
+        uint64_t value;
+        size_t end = 0;
+        if (!parseUnsigned(s, value, end) || end != s.size() || value == 0 || value > MaxThreads)
+            return false;
+        threads = static_cast<size_t>(value);
+        return true;
+    }
+
+    // Writes to a file descriptor, with vmsplice if it is a pipe.
+    class Output
+    {
+    public:
+        Output(int fd, bool allowSplice)
+            : mFd(fd), mSplice(false), mClosed(false)
+        {
+#ifdef __linux__
+            struct stat st;
+            if (allowSplice && fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode))
+            {
+                // vmsplice hands our pages to the pipe, so a chunk may only
+                // be reused once the pipe has certainly been drained of it.
+                // This is the case once the next chunk has been spliced, if
+                // a chunk is at least as large as the pipe.
+                fcntl(fd, F_SETPIPE_SZ, 1 << 20);
+                int pipeSize = fcntl(fd, F_GETPIPE_SZ);
+                mSplice = pipeSize > 0 && static_cast<uint64_t>(pipeSize) <= ChunkBytes;
+            }
+#else
+            (void)allowSplice;
+#endif
+        }
+
+        bool spliced() const { return mSplice; }
+
+        // true if the reader closed the pipe.
+        bool closed() const { return mClosed; }
+
+        // returns false if the output was closed or failed.
+        bool write(const uint8_t* data, size_t size)
+        {
+            while (size)
+            {
+                ssize_t n;
+#ifdef __linux__
+                if (mSplice)
+                {
+                    struct iovec iov = { const_cast<uint8_t*>(data), size };
+                    n = vmsplice(mFd, &iov, 1, 0);
+                }
+                else
+#endif
+                    n = ::write(mFd, data, size);
+
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    mClosed = errno == EPIPE;
+                    if (!mClosed)
+                        perror("simdcrypt-rng: write");
+                    return false;
+                }
+                data += n;
+                size -= n;
+            }
+            return true;
+        }
+
+    private:
+        int mFd;
+        bool mSplice;
+        bool mClosed;
+    };
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    block seed;
+    uint64_t bytes = Unlimited;
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    const char* path = nullptr;
+    bool allowSplice = true;
+
+    if (argc < 2 || !parseSeed(argv[1], seed))
+    {
+        usage();
+        return 1;
+    }
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc && parseBytes(argv[i + 1], bytes))
+            ++i;
+        else if (arg == "-t" && i + 1 < argc && parseThreads(argv[i + 1], numThreads))
+            ++i;
+        else if (arg == "-o" && i + 1 < argc)
+            path = argv[++i];
+        else if (arg == "--no-splice")
+            allowSplice = false;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    int fd = STDOUT_FILENO;
+    if (path)
+    {
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            perror("simdcrypt-rng: open");
+            return 1;
+        }
+    }
+
+    // a closed pipe ends the output normally.
+    signal(SIGPIPE, SIG_IGN);
+
+    Output out(fd, allowSplice);
+    AES aes(seed);
+
+    uint64_t numChunks = bytes == Unlimited ? Unlimited : (bytes + ChunkBytes - 1) / ChunkBytes;
+    auto chunkSize = [&](uint64_t k) {
+        return bytes == Unlimited ? ChunkBytes : std::min(ChunkBytes, bytes - k * ChunkBytes);
+    };
+
+    // one slot per thread plus two, so that the workers can run ahead
+    // while a chunk is being written and another one is still in the pipe.
+    size_t numSlots = numThreads + 2;
+    BlockArena arena(numSlots * ChunkBytes, HugePages::Transparent);
+    std::vector<uint8_t*> slots(numSlots);
+    for (auto& slot : slots)
+        slot = static_cast<uint8_t*>(arena.allocate(ChunkBytes));
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    // chunk index held by each slot, chunks below freed no longer need theirs.
+    std::vector<uint64_t> ready(numSlots, Unlimited);
+    uint64_t freed = 0;
+    bool stop = false;
+    std::atomic<uint64_t> next{ 0 };
+
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            uint64_t k = next.fetch_add(1);
+            if (k >= numChunks)
+                return;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return stop || k < freed + numSlots; });
+                if (stop)
+                    return;
+            }
+
+            uint64_t blocks = (chunkSize(k) + sizeof(block) - 1) / sizeof(block);
+            aes.ecbEncCounterMode(k * ChunkBlocks, blocks, reinterpret_cast<block*>(slots[k % numSlots]));
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[k % numSlots] = k;
+            }
+            cv.notify_all();
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i)
+        threads.emplace_back(worker);
+
+    uint64_t written = 0;
+    bool ok = true;
+    for (uint64_t k = 0; k < numChunks && ok; ++k)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return ready[k % numSlots] == k; });
+        }
+
+        ok = out.write(slots[k % numSlots], chunkSize(k));
+        if (ok)
+            written += chunkSize(k);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freed = out.spliced() ? k : k + 1;
+        }
+        cv.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& thrd : threads)
+        thrd.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "simdcrypt-rng: %llu bytes in %.3f s, %.2f GB/s (%zu threads, %s)\n",
+        static_cast<unsigned long long>(written), seconds, written / seconds / 1e9,
+        numThreads, out.spliced() ? "vmsplice" : "write");
+
+    if (path)
+        close(fd);
+
+    // the reader exiting early, e.g. `| head -c`, is not an error.
+    return ok || out.closed() ? 0 : 1;
+}